@@ -0,0 +1,50 @@
+#include "arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace memory {
+    Arena::~Arena() {
+        destroy();
+    }
+
+    bool Arena::init(size_t capacity) {
+        destroy();
+
+        // `aligned_alloc` requires the size to be a multiple of the alignment.
+        size_t blockSize = (capacity + kDefaultAlignment - 1) & ~(kDefaultAlignment - 1);
+        mMemory = static_cast<uint8_t*>(aligned_alloc(kDefaultAlignment, blockSize));
+        if (!mMemory) {
+            fprintf(stderr, "Unable to allocate an arena of %zu bytes.\n", blockSize);
+            return false;
+        }
+        mCapacity = blockSize;
+        mUsed = 0;
+        return true;
+    }
+
+    void Arena::destroy() {
+        free(mMemory);
+        mMemory = nullptr;
+        mCapacity = 0;
+        mUsed = 0;
+    }
+
+    void* Arena::alloc(size_t size, size_t alignment) {
+        // The address itself is aligned, the block only being aligned to `kDefaultAlignment`.
+        uintptr_t base = reinterpret_cast<uintptr_t>(mMemory);
+        uintptr_t address = (base + mUsed + alignment - 1) & ~(alignment - 1);
+        size_t offset = static_cast<size_t>(address - base);
+        if (!mMemory || offset > mCapacity || size > mCapacity - offset) {
+            fprintf(
+                stderr,
+                "Arena out of memory: %zu bytes requested, %zu of %zu bytes used.\n",
+                size,
+                mUsed,
+                mCapacity);
+            return nullptr;
+        }
+        mUsed = offset + size;
+        return mMemory + offset;
+    }
+}  // namespace memory
@@ -0,0 +1,73 @@
+#ifndef RENDEER_ARENA_HEADER
+#define RENDEER_ARENA_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace memory {
+    // Alignment of the arena memory block, and default alignment of its allocations. Matches the
+    // cache line size and is enough for any SIMD load.
+    static const size_t kDefaultAlignment = 64;
+
+    /**
+     * @brief Linear allocator carving allocations out of a single aligned memory block. Individual
+     *        allocations are never freed, the whole arena is either reset or destroyed at once.
+     */
+    class Arena {
+    public:
+        Arena() = default;
+        ~Arena();
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /**
+         * @brief Allocates the memory block of the arena.
+         *
+         * @param capacity Size of the memory block in bytes.
+         * @return True if the memory block was successfully allocated.
+         */
+        bool init(size_t capacity);
+
+        /** @brief Frees the memory block, invalidating every allocation. */
+        void destroy();
+
+        /**
+         * @brief Allocates a region of memory from the arena.
+         *
+         * @param size Size of the region in bytes.
+         * @param alignment Alignment of the region, must be a power of two. Alignments above
+         *        `kDefaultAlignment` are honored by padding the region within the block.
+         * @return Pointer to the region, or null if the arena is out of memory.
+         */
+        void* alloc(size_t size, size_t alignment = kDefaultAlignment);
+
+        /** @brief Allocates an array of `count` elements of type `T`, left uninitialized. */
+        template <typename T>
+        T* allocArray(size_t count, size_t alignment = kDefaultAlignment) {
+            return static_cast<T*>(alloc(count * sizeof(T), alignment));
+        }
+
+        /** @brief Invalidates every allocation, keeping the memory block. */
+        void reset() {
+            mUsed = 0;
+        }
+
+        /** @brief Number of bytes allocated so far, including alignment padding. */
+        size_t used() const {
+            return mUsed;
+        }
+
+        /** @brief Size of the memory block in bytes. */
+        size_t capacity() const {
+            return mCapacity;
+        }
+
+    private:
+        uint8_t* mMemory = nullptr;
+        size_t mCapacity = 0;
+        size_t mUsed = 0;
+    };
+}  // namespace memory
+
+#endif  // RENDEER_ARENA_HEADER
@@ -0,0 +1,89 @@
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "utils.h"
+
+namespace bench {
+    bool parseOptions(int argc, char** argv, Options& options) {
+        options.numFrames = 0;
+        if (utils::hasArg(argc, argv, "--benchmark") || utils::hasArg(argc, argv, "--headless")) {
+            options.numFrames = utils::parseArgSize(argc, argv, "--benchmark", kDefaultFrames);
+            if (options.numFrames == 0) {
+                fprintf(stderr, "The benchmark requires at least one frame.\n");
+                return false;
+            }
+        }
+
+        double stepRate = kDefaultStepRate;
+        const char* stepRateStr = utils::findArgValue(argc, argv, "--sim-rate");
+        if (stepRateStr) {
+            stepRate = strtod(stepRateStr, nullptr);
+            if (!(stepRate > 0.0)) {
+                fprintf(
+                    stderr,
+                    "Invalid simulation rate '%s', expected a positive number of steps per "
+                    "second.\n",
+                    stepRateStr);
+                return false;
+            }
+        }
+        options.stepSeconds = 1.0 / stepRate;
+        return true;
+    }
+
+    void FixedStep::init(double stepSeconds, bool lockstep) {
+        mStepSeconds = stepSeconds;
+        mAccumulated = 0.0;
+        mNumSteps = 0;
+        mLockstep = lockstep;
+    }
+
+    size_t FixedStep::advance(double elapsedSeconds) {
+        if (mLockstep) {
+            mNumSteps++;
+            return 1;
+        }
+        mAccumulated += elapsedSeconds;
+        size_t numSteps = 0;
+        while (mAccumulated >= mStepSeconds && numSteps < kMaxStepsPerFrame) {
+            mAccumulated -= mStepSeconds;
+            numSteps++;
+        }
+        if (numSteps == kMaxStepsPerFrame) {
+            mAccumulated = 0.0;
+        }
+        mNumSteps += numSteps;
+        return numSteps;
+    }
+
+    void printReport(const Report& report, telemetry::FrameStats& stats) {
+        telemetry::Summary frames = {};
+        stats.summarize(report.numFrames, frames);
+        double verticesPerSecond = report.totalSeconds > 0.0
+                                       ? static_cast<double>(report.verticesPerFrame) *
+                                             static_cast<double>(report.numFrames) /
+                                             report.totalSeconds
+                                       : 0.0;
+        printf(
+            "BENCHMARK {\"demo\": \"%s\", \"frames\": %zu, \"total_s\": %.6f, \"fps\": %.3f, "
+            "\"vertices_per_frame\": %llu, \"vertices_per_s\": %.0f, \"frame_ms_p50\": %.4f, "
+            "\"frame_ms_p99\": %.4f, \"frame_ms_max\": %.4f, \"sim_steps\": %llu, "
+            "\"sim_kernel\": \"%s\", \"state_hash\": \"%016llx\"}\n",
+            report.demo,
+            report.numFrames,
+            report.totalSeconds,
+            report.totalSeconds > 0.0
+                ? static_cast<double>(report.numFrames) / report.totalSeconds
+                : 0.0,
+            static_cast<unsigned long long>(report.verticesPerFrame),
+            verticesPerSecond,
+            static_cast<double>(frames.frame.p50),
+            static_cast<double>(frames.frame.p99),
+            static_cast<double>(frames.frame.max),
+            static_cast<unsigned long long>(report.numSteps),
+            report.simKernel,
+            static_cast<unsigned long long>(report.stateHash));
+    }
+}  // namespace bench
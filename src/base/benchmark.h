@@ -0,0 +1,102 @@
+#ifndef RENDEER_BENCHMARK_HEADER
+#define RENDEER_BENCHMARK_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frameStats.h"
+
+// Benchmark mode shared by the demos, and the fixed timestep clock driving their simulations, so
+// that the simulation advances at the same speed whatever the frame rate.
+namespace bench {
+    // Number of frames of a benchmark run when `--benchmark` is given without a value.
+    static const size_t kDefaultFrames = 1000;
+
+    // Default rate of the simulation steps, in steps per second, see `--sim-rate=HZ`.
+    static const double kDefaultStepRate = 60.0;
+
+    // Maximum number of steps simulated in a single frame. The time of slower frames is dropped,
+    // rather than spending ever longer frames catching up with it.
+    static const size_t kMaxStepsPerFrame = 8;
+
+    // Options of the benchmark mode.
+    struct Options {
+        // Number of frames rendered, zero outside of the benchmark mode.
+        size_t numFrames;
+        // Duration of a simulation step.
+        double stepSeconds;
+    };
+
+    /**
+     * @brief Parses `--benchmark[=N]`, running N frames as fast as possible, and `--sim-rate=HZ`.
+     *        A `--headless` run has no window to close, and is always a benchmark.
+     *
+     * @return False if an option is invalid.
+     */
+    bool parseOptions(int argc, char** argv, Options& options);
+
+    /**
+     * @brief Clock of a simulation advancing in fixed timesteps: the time elapsed between frames
+     *        is accumulated, and consumed in whole steps, so that the simulation depends on the
+     *        number of steps only, never on the frame rate.
+     *
+     * In lockstep, as in the benchmark mode, every frame simulates exactly one step whatever the
+     * time elapsed, so that a run of N frames always ends in the same state.
+     */
+    class FixedStep {
+    public:
+        /** @brief Resets the clock, with steps lasting `stepSeconds`. */
+        void init(double stepSeconds, bool lockstep = false);
+
+        /**
+         * @brief Accumulates the time elapsed since the last frame.
+         *
+         * @return Number of steps to simulate in this frame, at most `kMaxStepsPerFrame`.
+         */
+        size_t advance(double elapsedSeconds);
+
+        /** @brief Duration of a step. */
+        double stepSeconds() const {
+            return mStepSeconds;
+        }
+
+        /** @brief Number of steps simulated since `init`. */
+        uint64_t numSteps() const {
+            return mNumSteps;
+        }
+
+    private:
+        double mStepSeconds = 1.0 / kDefaultStepRate;
+        double mAccumulated = 0.0;
+        uint64_t mNumSteps = 0;
+        bool mLockstep = false;
+    };
+
+    // Results of a benchmark run.
+    struct Report {
+        // Name of the demo.
+        const char* demo;
+        size_t numFrames;
+        double totalSeconds;
+        // Number of vertices of the scene drawn per frame, before any culling.
+        uint64_t verticesPerFrame;
+        // Number of simulation steps, and hash of the simulated state at the end, which must match
+        // between runs of the same number of steps. Zero if the demo simulates nothing.
+        uint64_t numSteps;
+        uint64_t stateHash;
+        // Implementation of the simulation, such as the SIMD kernel of the CPU rotation. Kernels
+        // round differently, so the hashes are only comparable between runs of the same one.
+        const char* simKernel;
+    };
+
+    /**
+     * @brief Prints the results of a run on a single line, as a JSON object prefixed with
+     *        `BENCHMARK `, so that scripts can pick it out of the output of the demo.
+     *
+     * @param report Results of the run.
+     * @param stats Frame timings of the run, whose last `report.numFrames` are summarized.
+     */
+    void printReport(const Report& report, telemetry::FrameStats& stats);
+}  // namespace bench
+
+#endif  // RENDEER_BENCHMARK_HEADER
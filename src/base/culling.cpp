@@ -0,0 +1,275 @@
+#include "culling.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RENDEER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace culling {
+    // Number of frustum planes.
+    static const size_t kNumPlanes = 6;
+
+    Frustum extractFrustum(const linalg::Mat4& clipFromWorld) {
+        const linalg::Mat4& m = clipFromWorld;
+        Frustum frustum = {};
+        for (size_t axis = 0; axis < 3; axis++) {
+            for (size_t col = 0; col < 4; col++) {
+                // Planes `w + x >= 0` and `w - x >= 0`, and likewise for y and z.
+                frustum.planes[2 * axis][col] = m(3, col) + m(axis, col);
+                frustum.planes[2 * axis + 1][col] = m(3, col) - m(axis, col);
+            }
+        }
+        for (size_t plane = 0; plane < kNumPlanes; plane++) {
+            float* p = frustum.planes[plane];
+            float invLength = 1.0F / sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            for (size_t col = 0; col < 4; col++) {
+                p[col] *= invLength;
+            }
+        }
+        return frustum;
+    }
+
+    bool BoundsStore::init(size_t capacity) {
+        size_t padded = (capacity + kBatchSize - 1) & ~(kBatchSize - 1);
+        size_t numJobs = (capacity + kObjectsPerJob - 1) / kObjectsPerJob;
+        size_t arraySize = padded * sizeof(float) + memory::kDefaultAlignment;
+        if (!mArena.init(7 * arraySize + numJobs * sizeof(uint32_t))) {
+            return false;
+        }
+
+        float** arrays[7] = {
+            &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ, &mRadius};
+        for (float** array : arrays) {
+            *array = mArena.allocArray<float>(padded);
+            // The padding is never visible, but it must hold valid floats for the kernels.
+            memset(*array, 0, padded * sizeof(float));
+        }
+        mJobCounts = mArena.allocArray<uint32_t>(numJobs, alignof(uint32_t));
+        mCapacity = capacity;
+        mSize = 0;
+        return true;
+    }
+
+    void BoundsStore::clear() {
+        mSize = 0;
+    }
+
+    size_t BoundsStore::addBox(linalg::Vec3 center, linalg::Vec3 extent) {
+        if (mSize == mCapacity) {
+            return mCapacity;
+        }
+        mCenterX[mSize] = center.x;
+        mCenterY[mSize] = center.y;
+        mCenterZ[mSize] = center.z;
+        mExtentX[mSize] = extent.x;
+        mExtentY[mSize] = extent.y;
+        mExtentZ[mSize] = extent.z;
+        mRadius[mSize] = sqrtf(linalg::dot(extent, extent));
+        return mSize++;
+    }
+
+    size_t BoundsStore::addSphere(linalg::Vec3 center, float radius) {
+        return addBox(center, linalg::Vec3{radius, radius, radius});
+    }
+
+    /** @brief Plain scalar kernel, culling the objects of `[begin, end)`. */
+    static size_t cullScalar(
+        const Frustum& frustum,
+        const BoundsStore& store,
+        Volume volume,
+        size_t begin,
+        size_t end,
+        uint32_t* visible) {
+        size_t numVisible = 0;
+        for (size_t idx = begin; idx < end; idx++) {
+            bool inside = true;
+            for (size_t plane = 0; plane < kNumPlanes && inside; plane++) {
+                const float* p = frustum.planes[plane];
+                // Summed in the same order as the vectorized kernels, so that all of them agree
+                // on the objects lying exactly on a plane.
+                float dist = (p[0] * store.centerX()[idx] + p[1] * store.centerY()[idx]) +
+                             (p[2] * store.centerZ()[idx] + p[3]);
+                // Distance from the center to the plane of the corner closest to its inside.
+                if (volume == Volume::SPHERE) {
+                    dist += store.radius()[idx];
+                } else {
+                    dist += (fabsf(p[0]) * store.extentX()[idx] +
+                             fabsf(p[1]) * store.extentY()[idx]) +
+                            fabsf(p[2]) * store.extentZ()[idx];
+                }
+                inside = dist >= 0.0F;
+            }
+            if (inside) {
+                visible[numVisible++] = static_cast<uint32_t>(idx);
+            }
+        }
+        return numVisible;
+    }
+
+#if defined(RENDEER_X86)
+    /**
+     * @brief AVX kernel testing eight objects against a plane per instruction. `begin` must be a
+     *        multiple of `kBatchSize`, the padding of the arrays covering the last batch.
+     */
+    __attribute__((target("avx"))) static size_t cullAVX(
+        const Frustum& frustum,
+        const BoundsStore& store,
+        Volume volume,
+        size_t begin,
+        size_t end,
+        uint32_t* visible) {
+        __m256 planes[kNumPlanes][4];
+        __m256 absNormals[kNumPlanes][3];
+        for (size_t plane = 0; plane < kNumPlanes; plane++) {
+            for (size_t col = 0; col < 4; col++) {
+                planes[plane][col] = _mm256_set1_ps(frustum.planes[plane][col]);
+            }
+            for (size_t col = 0; col < 3; col++) {
+                absNormals[plane][col] = _mm256_set1_ps(fabsf(frustum.planes[plane][col]));
+            }
+        }
+        __m256 zero = _mm256_setzero_ps();
+
+        size_t numVisible = 0;
+        for (size_t idx = begin; idx < end; idx += kBatchSize) {
+            __m256 cx = _mm256_load_ps(store.centerX() + idx);
+            __m256 cy = _mm256_load_ps(store.centerY() + idx);
+            __m256 cz = _mm256_load_ps(store.centerZ() + idx);
+            __m256 ex = _mm256_load_ps(store.extentX() + idx);
+            __m256 ey = _mm256_load_ps(store.extentY() + idx);
+            __m256 ez = _mm256_load_ps(store.extentZ() + idx);
+            __m256 radius = _mm256_load_ps(store.radius() + idx);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (size_t plane = 0; plane < kNumPlanes; plane++) {
+                const __m256* p = planes[plane];
+                __m256 dist = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(p[0], cx), _mm256_mul_ps(p[1], cy)),
+                    _mm256_add_ps(_mm256_mul_ps(p[2], cz), p[3]));
+                if (volume == Volume::SPHERE) {
+                    dist = _mm256_add_ps(dist, radius);
+                } else {
+                    const __m256* n = absNormals[plane];
+                    dist = _mm256_add_ps(
+                        dist,
+                        _mm256_add_ps(
+                            _mm256_add_ps(_mm256_mul_ps(n[0], ex), _mm256_mul_ps(n[1], ey)),
+                            _mm256_mul_ps(n[2], ez)));
+                }
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, zero, _CMP_GE_OQ));
+            }
+
+            // Compaction: the set bits of the mask are the visible objects of the batch.
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+            if (end - idx < kBatchSize) {
+                mask &= (1U << (end - idx)) - 1;
+            }
+            while (mask != 0) {
+                uint32_t lane = static_cast<uint32_t>(__builtin_ctz(mask));
+                visible[numVisible++] = static_cast<uint32_t>(idx) + lane;
+                mask &= mask - 1;
+            }
+        }
+        return numVisible;
+    }
+#endif
+
+    /** @brief Culls the objects of `[begin, end)` with the given kernel. */
+    static size_t cullRange(
+        Kernel kernel,
+        const Frustum& frustum,
+        const BoundsStore& store,
+        Volume volume,
+        size_t begin,
+        size_t end,
+        uint32_t* visible) {
+        switch (kernel) {
+#if defined(RENDEER_X86)
+            case Kernel::AVX: {
+                return cullAVX(frustum, store, volume, begin, end, visible);
+            }
+#endif
+            default: {
+                return cullScalar(frustum, store, volume, begin, end, visible);
+            }
+        }
+    }
+
+    size_t cull(
+        const Frustum& frustum,
+        const BoundsStore& store,
+        Volume volume,
+        uint32_t* visible,
+        jobs::JobSystem* jobSystem,
+        Kernel kernel) {
+        size_t numObjects = store.size();
+        if (!jobSystem || numObjects <= kObjectsPerJob) {
+            return cullRange(kernel, frustum, store, volume, 0, numObjects, visible);
+        }
+
+        // Each job culls its range into the same range of `visible`, so that the jobs need no
+        // synchronization, and only records how many objects it kept.
+        size_t numJobs = (numObjects + kObjectsPerJob - 1) / kObjectsPerJob;
+        uint32_t* jobCounts = store.jobCounts();
+        jobSystem->parallelFor(0, numJobs, 1, [&](size_t beginJob, size_t endJob) {
+            TRACE_SCOPE("cullJob");
+            for (size_t job = beginJob; job < endJob; job++) {
+                size_t begin = job * kObjectsPerJob;
+                size_t end = begin + kObjectsPerJob < numObjects ? begin + kObjectsPerJob
+                                                                 : numObjects;
+                jobCounts[job] = static_cast<uint32_t>(
+                    cullRange(kernel, frustum, store, volume, begin, end, visible + begin));
+            }
+        });
+
+        // The first job already sits at the start of `visible`.
+        size_t numVisible = jobCounts[0];
+        for (size_t job = 1; job < numJobs; job++) {
+            memmove(
+                visible + numVisible,
+                visible + job * kObjectsPerJob,
+                jobCounts[job] * sizeof(uint32_t));
+            numVisible += jobCounts[job];
+        }
+        return numVisible;
+    }
+
+    bool isKernelSupported(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::SCALAR: {
+                return true;
+            }
+#if defined(RENDEER_X86)
+            case Kernel::AVX: {
+                return __builtin_cpu_supports("avx");
+            }
+#endif
+            default: {
+                return false;
+            }
+        }
+    }
+
+    Kernel bestKernel() {
+        static const Kernel kBest = isKernelSupported(Kernel::AVX) ? Kernel::AVX : Kernel::SCALAR;
+        return kBest;
+    }
+
+    const char* kernelName(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::SCALAR: {
+                return "scalar";
+            }
+            case Kernel::AVX: {
+                return "avx";
+            }
+        }
+        return "unknown";
+    }
+}  // namespace culling
@@ -0,0 +1,173 @@
+#ifndef RENDEER_CULLING_HEADER
+#define RENDEER_CULLING_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "jobs.h"
+#include "linalg.h"
+
+// Frustum culling of bounding volumes on the CPU. The volumes are stored as a structure of arrays,
+// so that the vectorized kernels test eight of them against a plane per instruction.
+namespace culling {
+    // Number of objects tested at once by the widest kernel, the arrays of a `BoundsStore` being
+    // padded to a multiple of it.
+    static const size_t kBatchSize = 8;
+
+    // Number of objects culled by each job, a multiple of `kBatchSize`.
+    static const size_t kObjectsPerJob = 1 << 14;
+
+    // Vectorized implementations of the culling kernel.
+    enum class Kernel {
+        SCALAR,
+        AVX,
+    };
+
+    // Bounding volume tested against the frustum.
+    enum class Volume {
+        SPHERE,
+        BOX,
+    };
+
+    /**
+     * @brief The six planes of a view frustum, left, right, bottom, top, near and far, as
+     *        normalized `(a, b, c, d)` coefficients. A point `p` lies inside a plane when
+     *        `a * p.x + b * p.y + c * p.z + d >= 0`.
+     */
+    struct Frustum {
+        float planes[6][4];
+    };
+
+    /**
+     * @brief Extracts the frustum planes from the rows of a projection matrix, following Gribb and
+     *        Hartmann. The planes are expressed in the space the matrix transforms from.
+     *
+     * @param clipFromWorld Matrix transforming to clip space, including any view transform.
+     */
+    Frustum extractFrustum(const linalg::Mat4& clipFromWorld);
+
+    /**
+     * @brief Structure of arrays holding a bounding sphere and an axis-aligned bounding box per
+     *        object, both centered on the same point, allocated once from an arena.
+     */
+    class BoundsStore {
+    public:
+        BoundsStore() = default;
+
+        BoundsStore(const BoundsStore&) = delete;
+        BoundsStore& operator=(const BoundsStore&) = delete;
+
+        /**
+         * @brief Allocates the arrays.
+         *
+         * @param capacity Maximum number of objects.
+         * @return True if the arrays were successfully allocated.
+         */
+        bool init(size_t capacity);
+
+        /** @brief Removes every object. */
+        void clear();
+
+        /**
+         * @brief Adds an object bounded by a box, its sphere being the one circumscribing the box.
+         *
+         * @param center Center of the box.
+         * @param extent Half size of the box along each axis.
+         * @return Index of the object, or `capacity()` if the store is full.
+         */
+        size_t addBox(linalg::Vec3 center, linalg::Vec3 extent);
+
+        /**
+         * @brief Adds an object bounded by a sphere, its box being the one circumscribing the
+         *        sphere.
+         *
+         * @return Index of the object, or `capacity()` if the store is full.
+         */
+        size_t addSphere(linalg::Vec3 center, float radius);
+
+        size_t size() const {
+            return mSize;
+        }
+
+        size_t capacity() const {
+            return mCapacity;
+        }
+
+        // Arrays of `capacity()` values, padded to a multiple of `kBatchSize`.
+        const float* centerX() const {
+            return mCenterX;
+        }
+        const float* centerY() const {
+            return mCenterY;
+        }
+        const float* centerZ() const {
+            return mCenterZ;
+        }
+        const float* extentX() const {
+            return mExtentX;
+        }
+        const float* extentY() const {
+            return mExtentY;
+        }
+        const float* extentZ() const {
+            return mExtentZ;
+        }
+        const float* radius() const {
+            return mRadius;
+        }
+
+        /** @brief Scratch array of the number of visible objects of each job, used by `cull`. */
+        uint32_t* jobCounts() const {
+            return mJobCounts;
+        }
+
+    private:
+        memory::Arena mArena;
+        size_t mSize = 0;
+        size_t mCapacity = 0;
+        float* mCenterX = nullptr;
+        float* mCenterY = nullptr;
+        float* mCenterZ = nullptr;
+        float* mExtentX = nullptr;
+        float* mExtentY = nullptr;
+        float* mExtentZ = nullptr;
+        float* mRadius = nullptr;
+        uint32_t* mJobCounts = nullptr;
+    };
+
+    /**
+     * @brief Tests every object of a store against a frustum and writes the indices of the visible
+     *        ones, in increasing order.
+     *
+     * The objects are split into ranges of `kObjectsPerJob`, each culled by a job into its own
+     * part of `visible`, which are then compacted together.
+     *
+     * @param frustum Frustum, in the space of the bounding volumes.
+     * @param store Bounding volumes of the objects.
+     * @param volume Bounding volume tested.
+     * @param visible Receives the indices of the visible objects, it must be large enough to hold
+     *        `store.size()` of them.
+     * @param jobSystem Pool running the jobs, or null to cull on the calling thread.
+     * @param kernel Kernel implementation, which must be supported by the running CPU.
+     * @return Number of visible objects.
+     */
+    size_t cull(
+        const Frustum& frustum,
+        const BoundsStore& store,
+        Volume volume,
+        uint32_t* visible,
+        jobs::JobSystem* jobSystem,
+        Kernel kernel);
+
+    /** @brief Whether the kernel was compiled in and can run on the current CPU. */
+    bool isKernelSupported(Kernel kernel);
+
+    /** @brief Fastest kernel supported by the running CPU, detected once at runtime. */
+    Kernel bestKernel();
+
+    /** @brief Human readable name of the kernel. */
+    const char* kernelName(Kernel kernel);
+}  // namespace culling
+
+#endif  // RENDEER_CULLING_HEADER
@@ -0,0 +1,302 @@
+#include "display.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(RENDEER_HEADLESS)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "trace.h"
+#include "utils.h"
+
+namespace display {
+    bool parseOptions(int argc, char** argv, Options& options) {
+        options.backend = utils::hasArg(argc, argv, "--headless") ? Backend::HEADLESS
+                                                                  : Backend::WINDOW;
+        options.capturePath = utils::findArgValue(argc, argv, "--capture");
+        options.captureFrame = utils::parseArgSize(argc, argv, "--capture-frame", 1);
+        if (options.captureFrame == 0) {
+            fprintf(stderr, "The captured frame counts from 1.\n");
+            return false;
+        }
+#if !defined(RENDEER_HEADLESS)
+        if (options.backend == Backend::HEADLESS) {
+            fprintf(stderr, "Headless rendering requires a build with EGL.\n");
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    /** @brief Seconds on a monotonic clock, the clock of the headless mode. */
+    static double monotonicSeconds() {
+        return static_cast<double>(tracing::nowNs()) * 1e-9;
+    }
+
+    /**
+     * @brief Writes the framebuffer bound for reading as a binary PPM image, flipping its rows,
+     *        since OpenGL reads them from the bottom.
+     */
+    static bool writeFramebufferPPM(const char* path, int width, int height) {
+        size_t rowSize = 3 * static_cast<size_t>(width);
+        std::vector<unsigned char> pixels(rowSize * static_cast<size_t>(height));
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+        FILE* file = fopen(path, "wb");
+        if (!file) {
+            fprintf(stderr, "Unable to open '%s' for writing.\n", path);
+            return false;
+        }
+        fprintf(file, "P6\n%d %d\n255\n", width, height);
+        for (size_t row = static_cast<size_t>(height); row > 0; row--) {
+            fwrite(pixels.data() + (row - 1) * rowSize, 1, rowSize, file);
+        }
+        if (fclose(file) != 0) {
+            fprintf(stderr, "Unable to write '%s'.\n", path);
+            return false;
+        }
+        printf("Captured a %dx%d frame to '%s'.\n", width, height, path);
+        return true;
+    }
+
+    bool Display::init(const char* name, const Options& options) {
+        mCapturePath = options.capturePath;
+        mCaptureFrame = options.captureFrame;
+        mNumFrames = 0;
+        if (options.backend == Backend::WINDOW) {
+            mWindow = utils::initGLFW(name);
+            mStartTime = glfwGetTime();
+            return true;
+        }
+        mStartTime = monotonicSeconds();
+        return initHeadless();
+    }
+
+#if defined(RENDEER_HEADLESS)
+    /** @brief Whether a space separated list of extensions includes `name`. */
+    static bool hasExtension(const char* extensions, const char* name) {
+        size_t nameLen = strlen(name);
+        for (const char* str = extensions; str && (str = strstr(str, name)); str += nameLen) {
+            bool startsWord = str == extensions || str[-1] == ' ';
+            if (startsWord && (str[nameLen] == ' ' || str[nameLen] == '\0')) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** @brief Opens the surfaceless platform of Mesa if available, else the default display. */
+    static EGLDisplay openEglDisplay() {
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless") &&
+            hasExtension(clientExtensions, "EGL_EXT_platform_base")) {
+            PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay) {
+                printf("Using the surfaceless EGL platform.\n");
+                return getPlatformDisplay(
+                    EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+        }
+        printf("Using the default EGL display.\n");
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    bool Display::initHeadless() {
+        printf("Creating headless EGL context...\n");
+        EGLDisplay eglDisplay = openEglDisplay();
+        EGLint major = 0;
+        EGLint minor = 0;
+        if (eglDisplay == EGL_NO_DISPLAY ||
+            eglInitialize(eglDisplay, &major, &minor) == EGL_FALSE) {
+            fprintf(stderr, "EGL failed to initialize...\n");
+            return false;
+        }
+        mEglDisplay = eglDisplay;
+        if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+            fprintf(stderr, "EGL doesn't support OpenGL...\n");
+            destroy();
+            return false;
+        }
+
+        const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+        EGLConfig config = nullptr;
+        EGLint numConfigs = 0;
+        if (eglChooseConfig(eglDisplay, configAttribs, &config, 1, &numConfigs) == EGL_FALSE ||
+            numConfigs == 0) {
+            fprintf(stderr, "EGL found no OpenGL config...\n");
+            destroy();
+            return false;
+        }
+        // The demos require OpenGL 4.6: GLSL 4.60, `gl_DrawID`, buffer storage and multi-draws.
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION,
+            4,
+            EGL_CONTEXT_MINOR_VERSION,
+            6,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK,
+            EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE,
+        };
+        EGLContext context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context == EGL_NO_CONTEXT) {
+            fprintf(stderr, "EGL failed to create an OpenGL 4.6 core context...\n");
+            destroy();
+            return false;
+        }
+        mEglContext = context;
+
+        // Without surfaceless contexts, a pbuffer is current but never drawn to.
+        EGLSurface surface = EGL_NO_SURFACE;
+        const char* extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+        if (!hasExtension(extensions, "EGL_KHR_surfaceless_context")) {
+            const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            surface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttribs);
+            if (surface == EGL_NO_SURFACE) {
+                fprintf(stderr, "EGL failed to create pbuffer...\n");
+                destroy();
+                return false;
+            }
+            mEglSurface = surface;
+        }
+        if (eglMakeCurrent(eglDisplay, surface, surface, context) == EGL_FALSE) {
+            fprintf(stderr, "EGL failed to make the context current...\n");
+            destroy();
+            return false;
+        }
+
+        int version = gladLoadGL(eglGetProcAddress);
+        if (version == 0) {
+            fprintf(stderr, "Glad failed to initialize OpenGL context\n");
+            destroy();
+            return false;
+        }
+        printf(
+            "Loaded OpenGL version: %d.%d (EGL %d.%d)\n",
+            GLAD_VERSION_MAJOR(version),
+            GLAD_VERSION_MINOR(version),
+            major,
+            minor);
+        if (!GLAD_GL_VERSION_4_6) {
+            fprintf(stderr, "The demos require OpenGL 4.6, which the EGL context doesn't offer.\n");
+            destroy();
+            return false;
+        }
+
+        // Same formats as the window: 8-bit color channels and 24 depth bits.
+        glGenRenderbuffers(2, mRenderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, mRenderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, utils::kWindowWidth, utils::kWindowHeight);
+        glBindRenderbuffer(GL_RENDERBUFFER, mRenderbuffers[1]);
+        glRenderbufferStorage(
+            GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, utils::kWindowWidth, utils::kWindowHeight);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &mFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mRenderbuffers[0]);
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mRenderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            fprintf(stderr, "The offscreen framebuffer is incomplete...\n");
+            destroy();
+            return false;
+        }
+
+        // A context made current without a surface starts with an empty viewport.
+        glViewport(0, 0, utils::kWindowWidth, utils::kWindowHeight);
+        printf(
+            "Rendering offscreen to a %dx%d framebuffer.\n",
+            utils::kWindowWidth,
+            utils::kWindowHeight);
+        return true;
+    }
+#else
+    bool Display::initHeadless() {
+        fprintf(stderr, "Headless rendering requires a build with EGL.\n");
+        return false;
+    }
+#endif
+
+    void Display::destroy() {
+        if (mWindow) {
+            glfwTerminate();
+            mWindow = nullptr;
+            return;
+        }
+#if defined(RENDEER_HEADLESS)
+        if (mFramebuffer != 0) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &mFramebuffer);
+            glDeleteRenderbuffers(2, mRenderbuffers);
+            mFramebuffer = 0;
+        }
+        if (mEglDisplay) {
+            printf("Destroying headless EGL context...\n");
+            eglMakeCurrent(mEglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (mEglSurface) {
+                eglDestroySurface(mEglDisplay, mEglSurface);
+            }
+            if (mEglContext) {
+                eglDestroyContext(mEglDisplay, mEglContext);
+            }
+            eglTerminate(mEglDisplay);
+        }
+        mEglSurface = nullptr;
+        mEglContext = nullptr;
+        mEglDisplay = nullptr;
+#endif
+    }
+
+    bool Display::shouldClose() const {
+        return mWindow && glfwWindowShouldClose(mWindow) == GLFW_TRUE;
+    }
+
+    void Display::setSwapInterval(int interval) {
+        if (mWindow) {
+            glfwSwapInterval(interval);
+        }
+    }
+
+    void Display::swapBuffers() {
+        mNumFrames++;
+        if (mCapturePath && mNumFrames == mCaptureFrame) {
+            int width = 0;
+            int height = 0;
+            framebufferSize(width, height);
+            writeFramebufferPPM(mCapturePath, width, height);
+        }
+        if (mWindow) {
+            glfwSwapBuffers(mWindow);
+        } else {
+            glFlush();
+        }
+    }
+
+    void Display::pollEvents() {
+        if (mWindow) {
+            glfwPollEvents();
+        }
+    }
+
+    double Display::time() const {
+        return (mWindow ? glfwGetTime() : monotonicSeconds()) - mStartTime;
+    }
+
+    void Display::framebufferSize(int& width, int& height) const {
+        if (mWindow) {
+            glfwGetFramebufferSize(mWindow, &width, &height);
+        } else {
+            width = utils::kWindowWidth;
+            height = utils::kWindowHeight;
+        }
+    }
+}  // namespace display
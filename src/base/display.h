@@ -0,0 +1,124 @@
+#ifndef RENDEER_DISPLAY_HEADER
+#define RENDEER_DISPLAY_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+
+// Where the demos render their frames: a GLFW window, or an offscreen framebuffer object of the
+// same size, in an EGL context which needs no display server, for headless servers and CI.
+namespace display {
+    // Backends a display can be created with.
+    enum class Backend {
+        // Visible GLFW window, presented by swapping its buffers.
+        WINDOW,
+        // EGL context without any window, drawing into a framebuffer object. Only available if
+        // the project is built with EGL, defining `RENDEER_HEADLESS`.
+        HEADLESS,
+    };
+
+    // Options of the display, selected at startup.
+    struct Options {
+        Backend backend;
+        // Path of the PPM image the frame `captureFrame` is written to, or null.
+        const char* capturePath;
+        // Frame captured, counting from 1.
+        size_t captureFrame;
+    };
+
+    /**
+     * @brief Parses `--headless`, `--capture=PATH` and `--capture-frame=N`, capturing the first
+     *        frame by default.
+     *
+     * @return False if an option is invalid.
+     */
+    bool parseOptions(int argc, char** argv, Options& options);
+
+    /**
+     * @brief Context of the demos and the framebuffer they render to, either a window or, in
+     *        headless mode, a framebuffer object with the size, color and depth formats of the
+     *        window, left bound to both targets, so that the demos render the same frames through
+     *        the same calls.
+     *
+     * The headless context prefers the surfaceless platform of Mesa,
+     * `EGL_MESA_platform_surfaceless`, falling back to the default display of EGL, with a 1x1
+     * pbuffer if the context can't be made current without a surface.
+     *
+     * The OpenGL objects are not released on destruction, `destroy` must be called explicitly.
+     */
+    class Display {
+    public:
+        Display() = default;
+
+        Display(const Display&) = delete;
+        Display& operator=(const Display&) = delete;
+
+        /**
+         * @brief Creates the context and makes it current, and loads the OpenGL functions.
+         *
+         * @param name Name of the window.
+         * @param options Options of the display.
+         * @return False if the context couldn't be created.
+         */
+        bool init(const char* name, const Options& options);
+
+        /** @brief Releases the framebuffer and the context, and terminates GLFW. */
+        void destroy();
+
+        /** @brief Window of the display, null in headless mode. */
+        GLFWwindow* window() const {
+            return mWindow;
+        }
+
+        /** @brief Whether the frames are rendered offscreen. */
+        bool isHeadless() const {
+            return mWindow == nullptr;
+        }
+
+        /**
+         * @brief Whether the window was asked to close, never in headless mode. The window stays
+         *        alive until `destroy`, so it mustn't be destroyed by a close callback.
+         */
+        bool shouldClose() const;
+
+        /** @brief Sets the number of vertical blanks per swap, ignored in headless mode. */
+        void setSwapInterval(int interval);
+
+        /**
+         * @brief Ends the frame: writes it to the capture path if it is the captured frame, then
+         *        presents it, or only flushes the commands in headless mode.
+         */
+        void swapBuffers();
+
+        /** @brief Processes the pending window events. */
+        void pollEvents();
+
+        /** @brief Seconds elapsed since `init`. */
+        double time() const;
+
+        /** @brief Size in pixels of the framebuffer rendered to. */
+        void framebufferSize(int& width, int& height) const;
+
+    private:
+        bool initHeadless();
+
+        GLFWwindow* mWindow = nullptr;
+        const char* mCapturePath = nullptr;
+        size_t mCaptureFrame = 0;
+        size_t mNumFrames = 0;
+        double mStartTime = 0.0;
+
+        // EGL display, context and surface, if any, of the headless mode.
+        void* mEglDisplay = nullptr;
+        void* mEglContext = nullptr;
+        void* mEglSurface = nullptr;
+
+        // Framebuffer object of the headless mode, and its color and depth renderbuffers.
+        GLuint mFramebuffer = 0;
+        GLuint mRenderbuffers[2] = {0, 0};
+    };
+}  // namespace display
+
+#endif  // RENDEER_DISPLAY_HEADER
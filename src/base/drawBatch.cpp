@@ -0,0 +1,191 @@
+#include "drawBatch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace batch {
+    /** @brief Creates a buffer of immutable size, updated with `glBufferSubData`. */
+    static GLuint createBuffer(size_t size) {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferStorage(
+            GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    /** @brief Writes to a buffer through the copy target, leaving the vertex array untouched. */
+    static void writeBuffer(GLuint buffer, size_t offset, size_t size, const void* data) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(
+            GL_COPY_WRITE_BUFFER,
+            static_cast<GLintptr>(offset),
+            static_cast<GLsizeiptr>(size),
+            data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    bool MeshBatch::init(
+        const vertex::Layout& layout,
+        GLuint vertexBinding,
+        size_t maxVertices,
+        size_t maxIndices,
+        size_t maxDraws,
+        size_t drawDataSize) {
+        mVertexSize = 0;
+        for (size_t idx = 0; idx < layout.numBindings; idx++) {
+            if (layout.bindings[idx].index == vertexBinding) {
+                mVertexSize = static_cast<size_t>(layout.bindings[idx].stride);
+            }
+        }
+        if (mVertexSize == 0) {
+            fprintf(stderr, "The vertex layout has no buffer binding %u.\n", vertexBinding);
+            return false;
+        }
+        if (maxVertices == 0 || maxIndices == 0 || maxDraws == 0) {
+            fprintf(stderr, "A mesh batch requires room for vertices, indices and draws.\n");
+            return false;
+        }
+        if (drawDataSize % 16 != 0) {
+            fprintf(stderr, "The per-draw data size must be a multiple of 16 bytes.\n");
+            return false;
+        }
+
+        size_t commandsSize = maxDraws * sizeof(DrawElementsIndirectCommand);
+        size_t drawDataTotal = maxDraws * drawDataSize;
+        if (!mArena.init(commandsSize + drawDataTotal + memory::kDefaultAlignment)) {
+            return false;
+        }
+        mCommands = mArena.allocArray<DrawElementsIndirectCommand>(maxDraws);
+        mDrawData = drawDataSize > 0 ? mArena.allocArray<uint8_t>(drawDataTotal) : nullptr;
+
+        mMaxVertices = maxVertices;
+        mMaxIndices = maxIndices;
+        mMaxDraws = maxDraws;
+        mDrawDataSize = drawDataSize;
+        mNumVertices = 0;
+        mNumIndices = 0;
+        mNumMeshes = 0;
+        mNumDraws = 0;
+        mDirty = false;
+
+        mVertexBuffer = createBuffer(maxVertices * mVertexSize);
+        mIndexBuffer = createBuffer(maxIndices * sizeof(uint32_t));
+        mCommandBuffer = createBuffer(commandsSize);
+        if (drawDataSize > 0) {
+            mDrawDataBuffer = createBuffer(drawDataTotal);
+        }
+
+        mVertexArray = vertex::createVertexArray(layout);
+        vertex::bindVertexBuffer(layout, vertexBinding, mVertexBuffer, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+        return true;
+    }
+
+    void MeshBatch::destroy() {
+        glDeleteVertexArrays(1, &mVertexArray);
+        glDeleteBuffers(1, &mVertexBuffer);
+        glDeleteBuffers(1, &mIndexBuffer);
+        glDeleteBuffers(1, &mCommandBuffer);
+        glDeleteBuffers(1, &mDrawDataBuffer);
+        mVertexArray = 0;
+        mVertexBuffer = 0;
+        mIndexBuffer = 0;
+        mCommandBuffer = 0;
+        mDrawDataBuffer = 0;
+        mArena.destroy();
+        mCommands = nullptr;
+        mDrawData = nullptr;
+    }
+
+    bool MeshBatch::addMesh(
+        const void* vertices,
+        size_t numVertices,
+        const uint32_t* indices,
+        size_t numIndices,
+        MeshRange& range) {
+        if (mNumVertices + numVertices > mMaxVertices || mNumIndices + numIndices > mMaxIndices) {
+            fprintf(
+                stderr,
+                "A mesh of %zu vertices and %zu indices doesn't fit in the batch.\n",
+                numVertices,
+                numIndices);
+            return false;
+        }
+
+        writeBuffer(mVertexBuffer, mNumVertices * mVertexSize, numVertices * mVertexSize, vertices);
+        writeBuffer(
+            mIndexBuffer, mNumIndices * sizeof(uint32_t), numIndices * sizeof(uint32_t), indices);
+
+        range.firstIndex = static_cast<GLuint>(mNumIndices);
+        range.numIndices = static_cast<GLuint>(numIndices);
+        range.baseVertex = static_cast<GLint>(mNumVertices);
+        range.numVertices = static_cast<GLuint>(numVertices);
+        mNumVertices += numVertices;
+        mNumIndices += numIndices;
+        mNumMeshes++;
+        return true;
+    }
+
+    void MeshBatch::clearDraws() {
+        mNumDraws = 0;
+        mDirty = true;
+    }
+
+    bool MeshBatch::addDraw(
+        const MeshRange& mesh,
+        const void* drawData,
+        GLuint instanceCount,
+        GLuint baseInstance) {
+        if (mNumDraws == mMaxDraws) {
+            fprintf(stderr, "The batch is limited to %zu draws.\n", mMaxDraws);
+            return false;
+        }
+
+        DrawElementsIndirectCommand& command = mCommands[mNumDraws];
+        command.count = mesh.numIndices;
+        command.instanceCount = instanceCount;
+        command.firstIndex = mesh.firstIndex;
+        command.baseVertex = mesh.baseVertex;
+        command.baseInstance = baseInstance;
+        if (mDrawDataSize > 0) {
+            memcpy(mDrawData + mNumDraws * mDrawDataSize, drawData, mDrawDataSize);
+        }
+        mNumDraws++;
+        mDirty = true;
+        return true;
+    }
+
+    void MeshBatch::draw(glstate::StateCache& state, GLuint drawDataBinding) {
+        if (mNumDraws == 0) {
+            return;
+        }
+
+        // The commands and the per-draw data are uploaded through the binding targets they are
+        // read from, which the state cache knows about.
+        state.bindVertexArray(mVertexArray);
+        state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+        if (mDirty) {
+            glBufferSubData(
+                GL_DRAW_INDIRECT_BUFFER,
+                0,
+                static_cast<GLsizeiptr>(mNumDraws * sizeof(DrawElementsIndirectCommand)),
+                mCommands);
+        }
+        if (mDrawDataSize > 0) {
+            state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding, mDrawDataBuffer);
+            if (mDirty) {
+                glBufferSubData(
+                    GL_SHADER_STORAGE_BUFFER,
+                    0,
+                    static_cast<GLsizeiptr>(mNumDraws * mDrawDataSize),
+                    mDrawData);
+            }
+        }
+        mDirty = false;
+
+        glMultiDrawElementsIndirect(
+            GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(mNumDraws), 0);
+    }
+}  // namespace batch
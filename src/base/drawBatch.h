@@ -0,0 +1,172 @@
+#ifndef RENDEER_DRAW_BATCH_HEADER
+#define RENDEER_DRAW_BATCH_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "glState.h"
+#include "vertexLayout.h"
+
+namespace batch {
+    // Command read by `glMultiDrawElementsIndirect`, laid out as mandated by OpenGL.
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Range of a mesh within the shared vertex and index buffers of a batch.
+    struct MeshRange {
+        // Offset of the first index, in indices.
+        GLuint firstIndex;
+        GLuint numIndices;
+        // Offset of the first vertex, added to every index of the mesh.
+        GLint baseVertex;
+        GLuint numVertices;
+    };
+
+    /**
+     * @brief Draws any number of indexed meshes sharing a vertex layout with a single
+     *        `glMultiDrawElementsIndirect` call. The vertices and 32-bit indices of every mesh are
+     *        suballocated from one vertex buffer and one index buffer, recorded once in the vertex
+     *        array of the batch, so that switching meshes costs no state change at all.
+     *
+     * Each draw has a block of `drawDataSize` bytes, stored at the index of the draw in a shader
+     * storage buffer, from which the shaders fetch their per-draw data with `gl_DrawID` (OpenGL
+     * 4.6 or `ARB_shader_draw_parameters`).
+     *
+     * The OpenGL objects are not released on destruction, since the context may already be gone,
+     * `destroy` must be called explicitly.
+     */
+    class MeshBatch {
+    public:
+        MeshBatch() = default;
+
+        MeshBatch(const MeshBatch&) = delete;
+        MeshBatch& operator=(const MeshBatch&) = delete;
+
+        /**
+         * @brief Creates the shared buffers and the vertex array of the batch. The vertex array is
+         *        left bound, so that the buffers of other bindings of the layout can be attached.
+         *
+         * @param layout Layout of the vertices, `vertexBinding` being the one holding the meshes.
+         * @param vertexBinding Index of the layout binding fetching the shared vertex buffer.
+         * @param maxVertices Capacity of the shared vertex buffer, in vertices.
+         * @param maxIndices Capacity of the shared index buffer, in indices.
+         * @param maxDraws Maximum number of draws per submission.
+         * @param drawDataSize Size in bytes of the per-draw data, a multiple of 16 to match the
+         *        array stride of a `std430` structure. Zero if the shaders don't need any.
+         * @return True if every object was created.
+         */
+        bool init(
+            const vertex::Layout& layout,
+            GLuint vertexBinding,
+            size_t maxVertices,
+            size_t maxIndices,
+            size_t maxDraws,
+            size_t drawDataSize);
+
+        /** @brief Deletes the buffers and the vertex array. */
+        void destroy();
+
+        /**
+         * @brief Appends a mesh to the shared buffers.
+         *
+         * @param vertices Vertices of the mesh, each of the stride of the vertex binding.
+         * @param numVertices Number of vertices.
+         * @param indices Indices into `vertices`, three per triangle.
+         * @param numIndices Number of indices.
+         * @param range Receives the range of the mesh, to be passed to `addDraw`.
+         * @return False if the shared buffers are full.
+         */
+        bool addMesh(
+            const void* vertices,
+            size_t numVertices,
+            const uint32_t* indices,
+            size_t numIndices,
+            MeshRange& range);
+
+        /** @brief Removes every draw, keeping the meshes. */
+        void clearDraws();
+
+        /**
+         * @brief Appends a draw of a mesh.
+         *
+         * @param mesh Range of the mesh returned by `addMesh`.
+         * @param drawData Per-draw data of `drawDataSize` bytes, ignored if that size is zero.
+         * @param instanceCount Number of instances drawn.
+         * @param baseInstance Offset added to the instance index of the attributes with a divisor.
+         * @return False if the batch already holds `maxDraws` draws.
+         */
+        bool addDraw(
+            const MeshRange& mesh,
+            const void* drawData,
+            GLuint instanceCount = 1,
+            GLuint baseInstance = 0);
+
+        /**
+         * @brief Draws every mesh of the batch with a single call. The commands and the per-draw
+         *        data are only uploaded again after the draws changed.
+         *
+         * @param state Cache through which the vertex array and the buffers are bound.
+         * @param drawDataBinding Binding point of the shader storage block holding the per-draw
+         *        data in the shaders.
+         */
+        void draw(glstate::StateCache& state, GLuint drawDataBinding);
+
+        /** @brief Vertex array recording the layout and the shared buffers of the batch. */
+        GLuint vertexArray() const {
+            return mVertexArray;
+        }
+
+        /** @brief Buffer of `DrawElementsIndirectCommand`, one per draw. */
+        GLuint commandBuffer() const {
+            return mCommandBuffer;
+        }
+
+        /** @brief Shader storage buffer holding the per-draw data. */
+        GLuint drawDataBuffer() const {
+            return mDrawDataBuffer;
+        }
+
+        size_t numMeshes() const {
+            return mNumMeshes;
+        }
+
+        size_t numDraws() const {
+            return mNumDraws;
+        }
+
+    private:
+        GLuint mVertexArray = 0;
+        GLuint mVertexBuffer = 0;
+        GLuint mIndexBuffer = 0;
+        GLuint mCommandBuffer = 0;
+        GLuint mDrawDataBuffer = 0;
+
+        size_t mVertexSize = 0;
+        size_t mMaxVertices = 0;
+        size_t mMaxIndices = 0;
+        size_t mMaxDraws = 0;
+        size_t mDrawDataSize = 0;
+        size_t mNumVertices = 0;
+        size_t mNumIndices = 0;
+        size_t mNumMeshes = 0;
+        size_t mNumDraws = 0;
+        bool mDirty = false;
+
+        // CPU copies of the commands and the per-draw data, uploaded by `draw`.
+        memory::Arena mArena;
+        DrawElementsIndirectCommand* mCommands = nullptr;
+        uint8_t* mDrawData = nullptr;
+    };
+}  // namespace batch
+
+#endif  // RENDEER_DRAW_BATCH_HEADER
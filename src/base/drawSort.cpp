@@ -0,0 +1,77 @@
+#include "drawSort.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace sorting {
+    // Number of bits sorted by each pass, and number of buckets of a pass.
+    static const unsigned kRadixBits = 8;
+    static const size_t kNumBuckets = 1 << kRadixBits;
+
+    // Number of bytes of a key, one pass each.
+    static const unsigned kNumPasses = 64 / kRadixBits;
+
+    uint64_t makeKey(
+        uint32_t program,
+        uint32_t material,
+        float depth,
+        float nearDepth,
+        float farDepth) {
+        float normalized = (depth - nearDepth) / (farDepth - nearDepth);
+        normalized = fminf(fmaxf(normalized, 0.0F), 1.0F);
+        // Quantized in double precision, as a float can't represent every 32-bit integer.
+        double maxDepth = static_cast<double>((1ULL << kDepthBits) - 1);
+        uint64_t quantized = static_cast<uint64_t>(static_cast<double>(normalized) * maxDepth);
+
+        uint64_t programField = program & ((1ULL << kProgramBits) - 1);
+        uint64_t materialField = material & ((1ULL << kMaterialBits) - 1);
+        return (programField << (kMaterialBits + kDepthBits)) | (materialField << kDepthBits) |
+               quantized;
+    }
+
+    void sortDraws(DrawItem* items, DrawItem* scratch, size_t numItems) {
+        if (numItems < 2) {
+            return;
+        }
+
+        // The histograms of every pass are built in a single read of the keys.
+        size_t counts[kNumPasses][kNumBuckets];
+        memset(counts, 0, sizeof(counts));
+        for (size_t idx = 0; idx < numItems; idx++) {
+            uint64_t key = items[idx].key;
+            for (unsigned pass = 0; pass < kNumPasses; pass++) {
+                counts[pass][(key >> (pass * kRadixBits)) & (kNumBuckets - 1)]++;
+            }
+        }
+
+        DrawItem* src = items;
+        DrawItem* dst = scratch;
+        for (unsigned pass = 0; pass < kNumPasses; pass++) {
+            size_t* passCounts = counts[pass];
+            unsigned shift = pass * kRadixBits;
+            size_t firstBucket = (src[0].key >> shift) & (kNumBuckets - 1);
+            if (passCounts[firstBucket] == numItems) {
+                continue;
+            }
+
+            // Exclusive prefix sum, giving the first slot of each bucket.
+            size_t offset = 0;
+            for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+                size_t count = passCounts[bucket];
+                passCounts[bucket] = offset;
+                offset += count;
+            }
+            for (size_t idx = 0; idx < numItems; idx++) {
+                dst[passCounts[(src[idx].key >> shift) & (kNumBuckets - 1)]++] = src[idx];
+            }
+
+            DrawItem* swap = src;
+            src = dst;
+            dst = swap;
+        }
+
+        if (src != items) {
+            memcpy(items, src, numItems * sizeof(DrawItem));
+        }
+    }
+}  // namespace sorting
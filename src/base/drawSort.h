@@ -0,0 +1,51 @@
+#ifndef RENDEER_DRAW_SORT_HEADER
+#define RENDEER_DRAW_SORT_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Ordering of the draws of a frame by a 64-bit key, so that draws sharing a program, and then a
+// material, are submitted together, and the opaque ones front-to-back within them: the nearest
+// surfaces fill the depth buffer first, and the early depth test rejects the fragments hidden
+// behind them before they are shaded.
+namespace sorting {
+    // Bits of the key given to each field, from the most significant one.
+    static const unsigned kProgramBits = 16;
+    static const unsigned kMaterialBits = 16;
+    static const unsigned kDepthBits = 32;
+
+    // Draw to be sorted: its key, and the index of the draw in the caller's own list.
+    struct DrawItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    /**
+     * @brief Builds the sort key of an opaque draw.
+     *
+     * @param program Identifier of the program, only its lowest `kProgramBits` bits are kept.
+     * @param material Identifier of the material, only its lowest `kMaterialBits` bits are kept.
+     * @param depth Distance of the draw from the camera along the view direction.
+     * @param nearDepth Depth mapped to the smallest key, nearer draws being clamped to it.
+     * @param farDepth Depth mapped to the largest key, farther draws being clamped to it.
+     */
+    uint64_t makeKey(
+        uint32_t program,
+        uint32_t material,
+        float depth,
+        float nearDepth,
+        float farDepth);
+
+    /**
+     * @brief Sorts draws by increasing key with a least significant digit radix sort, eight bits
+     *        at a time. The passes over bytes shared by every key, such as those of a single
+     *        program, are skipped. The sort is stable.
+     *
+     * @param items Draws to be sorted in place.
+     * @param scratch Array of the same size as `items`, whose contents are overwritten.
+     * @param numItems Number of draws.
+     */
+    void sortDraws(DrawItem* items, DrawItem* scratch, size_t numItems);
+}  // namespace sorting
+
+#endif  // RENDEER_DRAW_SORT_HEADER
@@ -0,0 +1,139 @@
+#include "fileView.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+namespace utils {
+    // Initial size of the buffer used when the file cannot be mapped.
+    static const size_t kInitialReadSize = 4096;
+
+    FileView::~FileView() {
+        close();
+    }
+
+    FileView::FileView(FileView&& other)
+        : mData(other.mData)
+        , mSize(other.mSize)
+        , mMapped(other.mMapped) {
+        other.mData = nullptr;
+        other.mSize = 0;
+        other.mMapped = false;
+    }
+
+    FileView& FileView::operator=(FileView&& other) {
+        if (this != &other) {
+            close();
+            mData = other.mData;
+            mSize = other.mSize;
+            mMapped = other.mMapped;
+            other.mData = nullptr;
+            other.mSize = 0;
+            other.mMapped = false;
+        }
+        return *this;
+    }
+
+    bool FileView::open(const char* path) {
+        TRACE_SCOPE("FileView::open");
+        close();
+
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            fprintf(stderr, "Couldn't open file %s: %s.\n", path, strerror(errno));
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == -1) {
+            fprintf(stderr, "Couldn't stat file %s: %s.\n", path, strerror(errno));
+            ::close(fd);
+            return false;
+        }
+
+        bool success = false;
+        if (S_ISREG(fileStat.st_mode) && fileStat.st_size > 0) {
+            size_t fileSize = static_cast<size_t>(fileStat.st_size);
+            void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                madvise(mapped, fileSize, MADV_SEQUENTIAL);
+                mData = static_cast<const char*>(mapped);
+                mSize = fileSize;
+                mMapped = true;
+                success = true;
+            }
+        }
+
+        // Special files, empty files (including those of pseudo file systems, which report a size
+        // of zero) and files that couldn't be mapped are read into a buffer.
+        if (!success) {
+            success = readBuffered(fd, path);
+        }
+
+        // The mapping stays valid after the descriptor is closed.
+        ::close(fd);
+        return success;
+    }
+
+    bool FileView::readBuffered(int fd, const char* path) {
+        size_t capacity = kInitialReadSize;
+        size_t size = 0;
+        char* buf = static_cast<char*>(malloc(capacity));
+        if (!buf) {
+            fprintf(stderr, "Couldn't allocate a buffer for file %s.\n", path);
+            return false;
+        }
+
+        while (true) {
+            if (size == capacity) {
+                capacity *= 2;
+                char* grown = static_cast<char*>(realloc(buf, capacity));
+                if (!grown) {
+                    fprintf(stderr, "Couldn't allocate a buffer for file %s.\n", path);
+                    free(buf);
+                    return false;
+                }
+                buf = grown;
+            }
+
+            ssize_t readCount = read(fd, buf + size, capacity - size);
+            if (readCount == 0) {
+                break;
+            }
+            if (readCount == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fprintf(stderr, "Couldn't read file %s: %s.\n", path, strerror(errno));
+                free(buf);
+                return false;
+            }
+            size += static_cast<size_t>(readCount);
+        }
+
+        mData = buf;
+        mSize = size;
+        mMapped = false;
+        return true;
+    }
+
+    void FileView::close() {
+        if (mData) {
+            if (mMapped) {
+                munmap(const_cast<char*>(mData), mSize);
+            } else {
+                free(const_cast<char*>(mData));
+            }
+        }
+        mData = nullptr;
+        mSize = 0;
+        mMapped = false;
+    }
+}  // namespace utils
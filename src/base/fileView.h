@@ -0,0 +1,60 @@
+#ifndef RENDEER_FILE_VIEW_HEADER
+#define RENDEER_FILE_VIEW_HEADER
+
+#include <stddef.h>
+
+namespace utils {
+    /**
+     * @brief Read-only view over the contents of a file. The file is memory mapped whenever
+     *        possible, so that loading it costs page faults instead of a heap copy; otherwise, such
+     *        as for pipes or special files, its contents are read into a heap buffer. Either way,
+     *        the memory is released when the view is closed or destroyed.
+     *
+     * The contents are not null-terminated, they are exposed as a pointer and a length.
+     */
+    class FileView {
+    public:
+        FileView() = default;
+        ~FileView();
+
+        FileView(const FileView&) = delete;
+        FileView& operator=(const FileView&) = delete;
+        FileView(FileView&& other);
+        FileView& operator=(FileView&& other);
+
+        /**
+         * @brief Opens a view over the contents of a file, closing any previously opened one.
+         *
+         * @param path Path to the file to be read.
+         * @return True if the contents of the file are available.
+         */
+        bool open(const char* path);
+
+        /** @brief Releases the contents of the file. */
+        void close();
+
+        /** @brief Pointer to the contents of the file, null if no file is open. */
+        const char* data() const {
+            return mData;
+        }
+
+        /** @brief Size in bytes of the contents of the file. */
+        size_t size() const {
+            return mSize;
+        }
+
+        /** @brief Whether the contents are memory mapped rather than copied into a buffer. */
+        bool isMapped() const {
+            return mMapped;
+        }
+
+    private:
+        bool readBuffered(int fd, const char* path);
+
+        const char* mData = nullptr;
+        size_t mSize = 0;
+        bool mMapped = false;
+    };
+}  // namespace utils
+
+#endif  // RENDEER_FILE_VIEW_HEADER
@@ -0,0 +1,293 @@
+#include "frameStats.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace telemetry {
+    /** @brief Milliseconds elapsed between two time points. */
+    template <typename TimePoint>
+    static float elapsedMs(TimePoint begin, TimePoint end) {
+        return std::chrono::duration<float, std::milli>(end - begin).count();
+    }
+
+    /**
+     * @brief Sorts the values in place and computes their percentiles, with the nearest-rank
+     *        method.
+     */
+    static Percentiles computePercentiles(float* values, size_t numValues) {
+        std::sort(values, values + numValues);
+        double sum = 0.0;
+        for (size_t idx = 0; idx < numValues; idx++) {
+            sum += static_cast<double>(values[idx]);
+        }
+        auto rank = [&](double fraction) {
+            size_t idx = static_cast<size_t>(ceil(fraction * static_cast<double>(numValues)));
+            return values[idx > 0 ? idx - 1 : 0];
+        };
+        return {
+            rank(0.50),
+            rank(0.95),
+            rank(0.99),
+            values[numValues - 1],
+            static_cast<float>(sum / static_cast<double>(numValues)),
+        };
+    }
+
+    bool FrameStats::init(size_t capacity) {
+        if (capacity == 0) {
+            fprintf(stderr, "The frame timing ring requires a capacity of at least one frame.\n");
+            return false;
+        }
+        mSlots = std::vector<Slot>(capacity);
+        mSamples.resize(capacity);
+        mSorted.resize(capacity);
+        mClaimed.store(0, std::memory_order_relaxed);
+        mCommitted.store(0, std::memory_order_release);
+        mLastReport = Clock::now();
+        mFramesAtLastReport = 0;
+        return true;
+    }
+
+    void FrameStats::beginFrame() {
+        mFrameStart = Clock::now();
+        mUpdateMs = 0.0F;
+        mSwapMs = 0.0F;
+    }
+
+    void FrameStats::beginUpdate() {
+        mUpdateStart = Clock::now();
+    }
+
+    void FrameStats::endUpdate() {
+        mUpdateMs += elapsedMs(mUpdateStart, Clock::now());
+    }
+
+    void FrameStats::beginSwap() {
+        mSwapStart = Clock::now();
+    }
+
+    void FrameStats::endSwap() {
+        mSwapMs += elapsedMs(mSwapStart, Clock::now());
+    }
+
+    void FrameStats::endFrame() {
+        if (mSlots.empty()) {
+            return;
+        }
+        float frameMs = elapsedMs(mFrameStart, Clock::now());
+
+        // The frame is claimed before its slot is overwritten, so that a reader copying the slot
+        // meanwhile sees the claim once done, and drops it.
+        uint64_t frame = mCommitted.load(std::memory_order_relaxed);
+        mClaimed.store(frame + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot& slot = mSlots[frame % mSlots.size()];
+        slot.frameMs.store(frameMs, std::memory_order_relaxed);
+        slot.updateMs.store(mUpdateMs, std::memory_order_relaxed);
+        slot.swapMs.store(mSwapMs, std::memory_order_relaxed);
+        mCommitted.store(frame + 1, std::memory_order_release);
+    }
+
+    size_t FrameStats::snapshot(FrameSample* samples, size_t maxSamples) const {
+        uint64_t capacity = mSlots.size();
+        uint64_t committed = mCommitted.load(std::memory_order_acquire);
+        uint64_t count = std::min<uint64_t>(std::min<uint64_t>(committed, capacity), maxSamples);
+        uint64_t first = committed - count;
+        for (uint64_t frame = first; frame < committed; frame++) {
+            const Slot& slot = mSlots[frame % capacity];
+            FrameSample& sample = samples[frame - first];
+            sample.frameMs = slot.frameMs.load(std::memory_order_relaxed);
+            sample.updateMs = slot.updateMs.load(std::memory_order_relaxed);
+            sample.swapMs = slot.swapMs.load(std::memory_order_relaxed);
+        }
+
+        // The frames claimed since then may have overwritten the oldest slots copied.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t claimed = mClaimed.load(std::memory_order_relaxed);
+        uint64_t firstValid = claimed > capacity ? claimed - capacity : 0;
+        if (firstValid <= first) {
+            return static_cast<size_t>(count);
+        }
+        if (firstValid >= committed) {
+            return 0;
+        }
+        uint64_t numDropped = firstValid - first;
+        memmove(samples, samples + numDropped, (count - numDropped) * sizeof(FrameSample));
+        return static_cast<size_t>(count - numDropped);
+    }
+
+    bool FrameStats::summarize(size_t lastFrames, Summary& summary) {
+        size_t numSamples = snapshot(mSamples.data(), std::min(lastFrames, mSamples.size()));
+        if (numSamples == 0) {
+            return false;
+        }
+
+        double frameSum = 0.0;
+        double jitterSum = 0.0;
+        for (size_t idx = 0; idx < numSamples; idx++) {
+            frameSum += static_cast<double>(mSamples[idx].frameMs);
+            if (idx > 0) {
+                jitterSum += static_cast<double>(
+                    fabsf(mSamples[idx].frameMs - mSamples[idx - 1].frameMs));
+            }
+        }
+        summary.numFrames = numSamples;
+        summary.fps = frameSum > 0.0 ? 1000.0 * static_cast<double>(numSamples) / frameSum : 0.0;
+        summary.jitterMs =
+            numSamples > 1 ? static_cast<float>(jitterSum / static_cast<double>(numSamples - 1))
+                           : 0.0F;
+
+        float FrameSample::*fields[3] = {
+            &FrameSample::frameMs, &FrameSample::updateMs, &FrameSample::swapMs};
+        Percentiles* percentiles[3] = {&summary.frame, &summary.update, &summary.swap};
+        for (size_t field = 0; field < 3; field++) {
+            for (size_t idx = 0; idx < numSamples; idx++) {
+                mSorted[idx] = mSamples[idx].*fields[field];
+            }
+            *percentiles[field] = computePercentiles(mSorted.data(), numSamples);
+        }
+        return true;
+    }
+
+    bool FrameStats::reportDue(double intervalSeconds, size_t& framesSinceReport) {
+        Clock::time_point now = Clock::now();
+        if (std::chrono::duration<double>(now - mLastReport).count() < intervalSeconds) {
+            return false;
+        }
+        uint64_t frames = numFrames();
+        framesSinceReport = static_cast<size_t>(frames - mFramesAtLastReport);
+        mFramesAtLastReport = frames;
+        mLastReport = now;
+        return true;
+    }
+
+    bool FrameStats::dump(const char* path) {
+        size_t length = strlen(path);
+        bool csv = length >= 4 && strcmp(path + length - 4, ".csv") == 0;
+        return csv ? writeCsv(path) : writeJson(path);
+    }
+
+    bool FrameStats::writeCsv(const char* path) {
+        size_t numSamples = snapshot(mSamples.data(), mSamples.size());
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            fprintf(stderr, "Unable to open '%s' for writing.\n", path);
+            return false;
+        }
+        fprintf(file, "frame,frame_ms,update_ms,swap_ms\n");
+        for (size_t idx = 0; idx < numSamples; idx++) {
+            fprintf(
+                file,
+                "%zu,%.4f,%.4f,%.4f\n",
+                idx,
+                static_cast<double>(mSamples[idx].frameMs),
+                static_cast<double>(mSamples[idx].updateMs),
+                static_cast<double>(mSamples[idx].swapMs));
+        }
+        if (fclose(file) != 0) {
+            fprintf(stderr, "Unable to write '%s'.\n", path);
+            return false;
+        }
+        printf("Wrote the timings of %zu frames to '%s'.\n", numSamples, path);
+        return true;
+    }
+
+    /** @brief Writes a set of percentiles as a JSON object. */
+    static void writeJsonPercentiles(FILE* file, const char* name, const Percentiles& p) {
+        fprintf(
+            file,
+            "  \"%s\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, "
+            "\"mean\": %.4f},\n",
+            name,
+            static_cast<double>(p.p50),
+            static_cast<double>(p.p95),
+            static_cast<double>(p.p99),
+            static_cast<double>(p.max),
+            static_cast<double>(p.mean));
+    }
+
+    bool FrameStats::writeJson(const char* path) {
+        // Leaves the summarized frames in `mSamples`, from which the histogram is built.
+        Summary summary = {};
+        if (!summarize(mSamples.size(), summary)) {
+            fprintf(stderr, "No frame to write to '%s'.\n", path);
+            return false;
+        }
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            fprintf(stderr, "Unable to open '%s' for writing.\n", path);
+            return false;
+        }
+
+        size_t histogram[kHistogramBuckets] = {};
+        for (size_t idx = 0; idx < summary.numFrames; idx++) {
+            size_t bucket = static_cast<size_t>(mSamples[idx].frameMs / kHistogramBucketMs);
+            histogram[std::min(bucket, kHistogramBuckets - 1)]++;
+        }
+        size_t numBuckets = kHistogramBuckets;
+        while (numBuckets > 1 && histogram[numBuckets - 1] == 0) {
+            numBuckets--;
+        }
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"frames\": %zu,\n", summary.numFrames);
+        fprintf(file, "  \"fps\": %.3f,\n", summary.fps);
+        writeJsonPercentiles(file, "frame_ms", summary.frame);
+        writeJsonPercentiles(file, "update_ms", summary.update);
+        writeJsonPercentiles(file, "swap_ms", summary.swap);
+        fprintf(file, "  \"jitter_ms\": %.4f,\n", static_cast<double>(summary.jitterMs));
+        fprintf(
+            file,
+            "  \"frame_ms_histogram\": {\"bucket_ms\": %.3f, \"counts\": [",
+            static_cast<double>(kHistogramBucketMs));
+        for (size_t bucket = 0; bucket < numBuckets; bucket++) {
+            fprintf(file, "%s%zu", bucket > 0 ? ", " : "", histogram[bucket]);
+        }
+        fprintf(file, "]}\n}\n");
+        if (fclose(file) != 0) {
+            fprintf(stderr, "Unable to write '%s'.\n", path);
+            return false;
+        }
+        printf("Wrote the summary of %zu frames to '%s'.\n", summary.numFrames, path);
+        return true;
+    }
+
+    void formatSummary(const Summary& summary, char* str, size_t size) {
+        snprintf(
+            str,
+            size,
+            "frame p50 %.2f p95 %.2f p99 %.2f max %.2f ms, jitter %.2f ms",
+            static_cast<double>(summary.frame.p50),
+            static_cast<double>(summary.frame.p95),
+            static_cast<double>(summary.frame.p99),
+            static_cast<double>(summary.frame.max),
+            static_cast<double>(summary.jitterMs));
+    }
+
+    void reportAtExit(FrameStats& stats, const char* dumpPath) {
+        Summary summary = {};
+        if (!stats.summarize(SIZE_MAX, summary)) {
+            return;
+        }
+        printf("Timings of the last %zu frames (ms):\n", summary.numFrames);
+        const char* names[3] = {"frame", "update", "swap"};
+        const Percentiles* percentiles[3] = {&summary.frame, &summary.update, &summary.swap};
+        for (size_t field = 0; field < 3; field++) {
+            const Percentiles& p = *percentiles[field];
+            printf(
+                "  %-6s p50 %7.3f  p95 %7.3f  p99 %7.3f  max %7.3f  mean %7.3f\n",
+                names[field],
+                static_cast<double>(p.p50),
+                static_cast<double>(p.p95),
+                static_cast<double>(p.p99),
+                static_cast<double>(p.max),
+                static_cast<double>(p.mean));
+        }
+        printf("  jitter %.3f, %.1f FPS\n", static_cast<double>(summary.jitterMs), summary.fps);
+        if (dumpPath) {
+            stats.dump(dumpPath);
+        }
+    }
+}  // namespace telemetry
@@ -0,0 +1,181 @@
+#ifndef RENDEER_FRAME_STATS_HEADER
+#define RENDEER_FRAME_STATS_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Frame pacing telemetry: the timings of every frame are recorded in a ring, from which the
+// percentiles of the recent frames are reported while running, and the whole ring dumped at exit.
+namespace telemetry {
+    // Default number of frames kept by the ring, about a minute at 60 Hz.
+    static const size_t kDefaultCapacity = 4096;
+
+    // Width and number of the buckets of the frame time histogram, the last one gathering every
+    // longer frame.
+    static const float kHistogramBucketMs = 1.0F;
+    static const size_t kHistogramBuckets = 100;
+
+    // Timings of a single frame, in milliseconds, measured on the CPU.
+    struct FrameSample {
+        // Time from the start of the frame to the end of the frame.
+        float frameMs;
+        // Time spent updating the scene, zero if the frame doesn't mark it.
+        float updateMs;
+        // Time spent in the swap, where the presentation and any vsync wait block.
+        float swapMs;
+    };
+
+    // Distribution of one of the timings over a set of frames.
+    struct Percentiles {
+        float p50;
+        float p95;
+        float p99;
+        float max;
+        float mean;
+    };
+
+    // Summary of a set of consecutive frames.
+    struct Summary {
+        size_t numFrames;
+        // Frames per second, over the summed frame times.
+        double fps;
+        Percentiles frame;
+        Percentiles update;
+        Percentiles swap;
+        // Mean absolute difference between the times of consecutive frames, zero for perfectly
+        // paced frames whatever their duration.
+        float jitterMs;
+    };
+
+    /**
+     * @brief Ring of the timings of the last frames, recorded by the thread running the frames.
+     *
+     * The ring is lock-free: the recording thread never waits, and `snapshot` may be called from
+     * any thread. Readers detect the slots overwritten while they copied them, as with a seqlock,
+     * and drop them. `summarize` and the dumps use scratch memory of the ring, and must be called
+     * from the recording thread.
+     */
+    class FrameStats {
+    public:
+        FrameStats() = default;
+
+        FrameStats(const FrameStats&) = delete;
+        FrameStats& operator=(const FrameStats&) = delete;
+
+        /**
+         * @brief Allocates the ring.
+         *
+         * @param capacity Number of frames kept.
+         * @return False if the capacity is zero.
+         */
+        bool init(size_t capacity = kDefaultCapacity);
+
+        /** @brief Marks the start of a frame. */
+        void beginFrame();
+
+        /** @brief Marks the start of the update of the scene. */
+        void beginUpdate();
+
+        /** @brief Marks the end of the update of the scene. */
+        void endUpdate();
+
+        /** @brief Marks the start of the buffer swap. */
+        void beginSwap();
+
+        /** @brief Marks the end of the buffer swap. */
+        void endSwap();
+
+        /** @brief Marks the end of the frame, and publishes its timings to the ring. */
+        void endFrame();
+
+        /** @brief Number of frames recorded since `init`, including those overwritten since. */
+        uint64_t numFrames() const {
+            return mCommitted.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Copies the timings of the last frames still in the ring.
+         *
+         * @param samples Receives the timings, from the oldest frame to the latest one.
+         * @param maxSamples Maximum number of frames copied.
+         * @return Number of frames copied.
+         */
+        size_t snapshot(FrameSample* samples, size_t maxSamples) const;
+
+        /**
+         * @brief Summarizes the last frames still in the ring.
+         *
+         * @param lastFrames Maximum number of frames summarized.
+         * @param summary Receives the summary.
+         * @return False if no frame was recorded.
+         */
+        bool summarize(size_t lastFrames, Summary& summary);
+
+        /**
+         * @brief Checks whether a report is due, once per interval. The interval restarts from the
+         *        check that returned true, so that a long frame doesn't make reports pile up.
+         *
+         * @param intervalSeconds Time between two reports.
+         * @param framesSinceReport Receives the number of frames recorded since the last report.
+         * @return True if the report is due.
+         */
+        bool reportDue(double intervalSeconds, size_t& framesSinceReport);
+
+        /**
+         * @brief Writes the timings of every frame still in the ring to a file: one row per frame
+         *        if `path` ends with `.csv`, otherwise the summary of the frames and the histogram
+         *        of their times as JSON.
+         *
+         * @return False if the file couldn't be written.
+         */
+        bool dump(const char* path);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // Timings of a frame in the ring, atomic so that readers can copy them as they're written.
+        struct Slot {
+            std::atomic<float> frameMs;
+            std::atomic<float> updateMs;
+            std::atomic<float> swapMs;
+        };
+
+        bool writeCsv(const char* path);
+        bool writeJson(const char* path);
+
+        std::vector<Slot> mSlots;
+        // Number of frames whose writing started, and number of frames fully written.
+        std::atomic<uint64_t> mClaimed{0};
+        std::atomic<uint64_t> mCommitted{0};
+
+        Clock::time_point mFrameStart;
+        Clock::time_point mUpdateStart;
+        Clock::time_point mSwapStart;
+        float mUpdateMs = 0.0F;
+        float mSwapMs = 0.0F;
+
+        Clock::time_point mLastReport;
+        uint64_t mFramesAtLastReport = 0;
+
+        // Scratch memory of `summarize` and `dump`.
+        std::vector<FrameSample> mSamples;
+        std::vector<float> mSorted;
+    };
+
+    /**
+     * @brief Formats the frame time percentiles and the jitter of a summary on a single line, such
+     *        as `frame p50 16.67 p95 16.94 p99 17.20 max 18.02 ms, jitter 0.15 ms`.
+     */
+    void formatSummary(const Summary& summary, char* str, size_t size);
+
+    /**
+     * @brief Prints the percentiles of every timing over the frames still in the ring, and dumps
+     *        them with `FrameStats::dump` unless `dumpPath` is null.
+     */
+    void reportAtExit(FrameStats& stats, const char* dumpPath);
+}  // namespace telemetry
+
+#endif  // RENDEER_FRAME_STATS_HEADER
@@ -0,0 +1,159 @@
+#include "glState.h"
+
+namespace glstate {
+    // Index into the shadowed buffer bindings, or `kNumBufferTargets` if the target isn't tracked.
+    static size_t bufferTargetIdx(GLenum target) {
+        switch (target) {
+            case GL_ARRAY_BUFFER:
+                return 0;
+            case GL_ELEMENT_ARRAY_BUFFER:
+                return 1;
+            case GL_COPY_READ_BUFFER:
+                return 2;
+            case GL_COPY_WRITE_BUFFER:
+                return 3;
+            case GL_UNIFORM_BUFFER:
+                return 4;
+            case GL_SHADER_STORAGE_BUFFER:
+                return 5;
+            case GL_DRAW_INDIRECT_BUFFER:
+                return 6;
+            case GL_DISPATCH_INDIRECT_BUFFER:
+                return 7;
+            case GL_PIXEL_PACK_BUFFER:
+                return 8;
+            case GL_PIXEL_UNPACK_BUFFER:
+                return 9;
+            default:
+                return kNumBufferTargets;
+        }
+    }
+
+    // Index into the shadowed capabilities, or `kNumCapabilities` if the capability isn't tracked.
+    static size_t capabilityIdx(GLenum capability) {
+        switch (capability) {
+            case GL_BLEND:
+                return 0;
+            case GL_CULL_FACE:
+                return 1;
+            case GL_DEPTH_TEST:
+                return 2;
+            case GL_STENCIL_TEST:
+                return 3;
+            case GL_SCISSOR_TEST:
+                return 4;
+            case GL_RASTERIZER_DISCARD:
+                return 5;
+            case GL_PRIMITIVE_RESTART:
+                return 6;
+            case GL_POLYGON_OFFSET_FILL:
+                return 7;
+            case GL_FRAMEBUFFER_SRGB:
+                return 8;
+            case GL_PROGRAM_POINT_SIZE:
+                return 9;
+            default:
+                return kNumCapabilities;
+        }
+    }
+
+    void StateCache::useProgram(GLuint program) {
+        if (program == mProgram) {
+            mFrame.skipped++;
+            return;
+        }
+        glUseProgram(program);
+        mProgram = program;
+        mFrame.issued++;
+    }
+
+    void StateCache::bindVertexArray(GLuint vao) {
+        if (vao == mVertexArray) {
+            mFrame.skipped++;
+            return;
+        }
+        glBindVertexArray(vao);
+        mVertexArray = vao;
+        // The element array buffer binding is part of the vertex array state.
+        mBuffers[bufferTargetIdx(GL_ELEMENT_ARRAY_BUFFER)] = kUnknownObject;
+        mFrame.issued++;
+    }
+
+    void StateCache::bindBuffer(GLenum target, GLuint buffer) {
+        size_t idx = bufferTargetIdx(target);
+        if (idx < kNumBufferTargets) {
+            if (mBuffers[idx] == buffer) {
+                mFrame.skipped++;
+                return;
+            }
+            mBuffers[idx] = buffer;
+        }
+        glBindBuffer(target, buffer);
+        mFrame.issued++;
+    }
+
+    void StateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        size_t idx = bufferTargetIdx(target);
+        if (idx < kNumBufferTargets) {
+            mBuffers[idx] = buffer;
+        }
+        glBindBufferBase(target, index, buffer);
+        mFrame.issued++;
+    }
+
+    void StateCache::bindBufferRange(
+        GLenum target,
+        GLuint index,
+        GLuint buffer,
+        GLintptr offset,
+        GLsizeiptr size) {
+        size_t idx = bufferTargetIdx(target);
+        if (idx < kNumBufferTargets) {
+            mBuffers[idx] = buffer;
+        }
+        glBindBufferRange(target, index, buffer, offset, size);
+        mFrame.issued++;
+    }
+
+    void StateCache::enable(GLenum capability) {
+        setCapability(capability, true);
+    }
+
+    void StateCache::disable(GLenum capability) {
+        setCapability(capability, false);
+    }
+
+    void StateCache::setCapability(GLenum capability, bool enabled) {
+        Toggle value = enabled ? Toggle::ENABLED : Toggle::DISABLED;
+        size_t idx = capabilityIdx(capability);
+        if (idx < kNumCapabilities) {
+            if (mCapabilities[idx] == value) {
+                mFrame.skipped++;
+                return;
+            }
+            mCapabilities[idx] = value;
+        }
+        if (enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+        mFrame.issued++;
+    }
+
+    void StateCache::invalidate() {
+        mProgram = kUnknownObject;
+        mVertexArray = kUnknownObject;
+        for (size_t idx = 0; idx < kNumBufferTargets; idx++) {
+            mBuffers[idx] = kUnknownObject;
+        }
+        for (size_t idx = 0; idx < kNumCapabilities; idx++) {
+            mCapabilities[idx] = Toggle::UNKNOWN;
+        }
+    }
+
+    void StateCache::endFrame() {
+        mLastFrame = mFrame;
+        mFrame = Stats{0, 0};
+    }
+}  // namespace glstate
@@ -0,0 +1,94 @@
+#ifndef RENDEER_GL_STATE_HEADER
+#define RENDEER_GL_STATE_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace glstate {
+    // Buffer binding targets tracked by the cache, binding to other targets is always issued.
+    static const size_t kNumBufferTargets = 10;
+
+    // Capabilities tracked by the cache, toggling other capabilities is always issued.
+    static const size_t kNumCapabilities = 10;
+
+    // Number of state changes requested during a frame.
+    struct Stats {
+        // Calls forwarded to OpenGL.
+        size_t issued;
+        // Calls dropped because they wouldn't change the current state.
+        size_t skipped;
+    };
+
+    /**
+     * @brief Shadows the bound program, vertex array and buffers, and the enabled capabilities of
+     *        the current context, dropping the calls that would set them to their current value.
+     *
+     * The cache only knows about the changes made through it: after changing the same state
+     * directly, or deleting a bound object, `invalidate` must be called. The state starts unknown,
+     * so that the first call of each kind is always issued.
+     */
+    class StateCache {
+    public:
+        StateCache() {
+            invalidate();
+        }
+
+        void useProgram(GLuint program);
+        void bindVertexArray(GLuint vao);
+        void bindBuffer(GLenum target, GLuint buffer);
+
+        /**
+         * @brief Binds a buffer to an indexed binding point. The indexed bindings aren't shadowed,
+         *        so the call is always issued, but it also binds the buffer to the generic binding
+         *        of `target`, which is kept in sync.
+         */
+        void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+        /** @brief Same as `bindBufferBase`, binding a range of the buffer. */
+        void bindBufferRange(
+            GLenum target,
+            GLuint index,
+            GLuint buffer,
+            GLintptr offset,
+            GLsizeiptr size);
+        void enable(GLenum capability);
+        void disable(GLenum capability);
+
+        /** @brief Forgets the whole shadowed state, the next call of each kind is issued. */
+        void invalidate();
+
+        /** @brief Closes the current frame, whose counts become available from `lastFrame`. */
+        void endFrame();
+
+        /** @brief Counts of the last frame closed by `endFrame`. */
+        const Stats& lastFrame() const {
+            return mLastFrame;
+        }
+
+    private:
+        void setCapability(GLenum capability, bool enabled);
+
+        // Sentinel marking unknown object bindings, never returned by `glGen*`.
+        static const GLuint kUnknownObject = 0xFFFFFFFF;
+
+        // Value of a capability.
+        enum class Toggle : uint8_t {
+            UNKNOWN,
+            ENABLED,
+            DISABLED,
+        };
+
+        GLuint mProgram;
+        GLuint mVertexArray;
+        GLuint mBuffers[kNumBufferTargets];
+        Toggle mCapabilities[kNumCapabilities];
+        Stats mFrame = {0, 0};
+        Stats mLastFrame = {0, 0};
+    };
+}  // namespace glstate
+
+#endif  // RENDEER_GL_STATE_HEADER
@@ -0,0 +1,168 @@
+#include "gpuProfiler.h"
+
+#include <stdio.h>
+
+#include "trace.h"
+
+namespace profiling {
+    // Number of frames between two calibrations of the GPU clock against the CPU clock, which
+    // drift apart slowly.
+    static const uint64_t kCalibrationFrames = 256;
+
+    void GpuProfiler::calibrate() {
+        GLint64 gpuNs = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNs);
+        mGpuToCpuNs = static_cast<int64_t>(tracing::nowNs()) - gpuNs;
+    }
+
+    bool GpuProfiler::init(size_t numFrames) {
+        if (numFrames < 2 || numFrames > kMaxFrames) {
+            fprintf(
+                stderr,
+                "The GPU profiler requires between 2 and %zu frames, %zu requested.\n",
+                kMaxFrames,
+                numFrames);
+            return false;
+        }
+        mNumFrames = numFrames;
+        for (size_t idx = 0; idx < mNumFrames; idx++) {
+            Frame& frame = mFrames[idx];
+            glGenQueries(2 * kMaxScopes, frame.queries);
+            frame.numScopes = 0;
+            frame.lastQuery = 0;
+            frame.pending = false;
+        }
+        mCurrent = 0;
+        mRecording = false;
+        mNumResults = 0;
+        mNumDropped = 0;
+        mFrameIndex = 0;
+        calibrate();
+        return true;
+    }
+
+    void GpuProfiler::destroy() {
+        for (size_t idx = 0; idx < mNumFrames; idx++) {
+            glDeleteQueries(2 * kMaxScopes, mFrames[idx].queries);
+        }
+        mNumFrames = 0;
+    }
+
+    void GpuProfiler::collect(Frame& frame) {
+        frame.pending = false;
+        if (frame.numScopes == 0) {
+            return;
+        }
+
+        // The timestamps complete in the order they are issued, so the last one issued being
+        // available implies the others, and reading them doesn't wait on the GPU.
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.queries[frame.lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            mNumDropped++;
+            return;
+        }
+
+        for (size_t idx = 0; idx < frame.numScopes; idx++) {
+            ScopeResult& scope = frame.scopes[idx];
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(frame.queries[2 * idx], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.queries[2 * idx + 1], GL_QUERY_RESULT, &end);
+            scope.gpuBeginNs = begin;
+            scope.gpuEndNs = end;
+            scope.gpuMs = end > begin ? static_cast<double>(end - begin) * 1e-6 : 0.0;
+            scope.cpuMs = static_cast<double>(scope.cpuEndNs - scope.cpuBeginNs) * 1e-6;
+            mResults[idx] = scope;
+            tracing::recordGpuEvent(scope.name, toCpuNs(begin), toCpuNs(end));
+        }
+        mNumResults = frame.numScopes;
+    }
+
+    void GpuProfiler::beginFrame() {
+        if (mNumFrames == 0) {
+            return;
+        }
+        Frame& frame = mFrames[mCurrent];
+        if (frame.pending) {
+            collect(frame);
+        }
+        if (++mFrameIndex % kCalibrationFrames == 0) {
+            calibrate();
+        }
+        frame.numScopes = 0;
+        frame.lastQuery = 0;
+        mDepth = 0;
+        mIgnoredScopes = 0;
+        mRecording = true;
+    }
+
+    void GpuProfiler::beginScope(const char* name) {
+        Frame& frame = mFrames[mCurrent];
+        if (!mRecording || frame.numScopes == kMaxScopes || mDepth == kMaxDepth) {
+            mIgnoredScopes++;
+            return;
+        }
+        size_t idx = frame.numScopes++;
+        ScopeResult& scope = frame.scopes[idx];
+        scope.name = name;
+        scope.depth = static_cast<uint32_t>(mDepth);
+        scope.cpuBeginNs = tracing::nowNs();
+        scope.cpuEndNs = scope.cpuBeginNs;
+        glQueryCounter(frame.queries[2 * idx], GL_TIMESTAMP);
+        frame.lastQuery = 2 * idx;
+        mOpenScopes[mDepth++] = idx;
+    }
+
+    void GpuProfiler::endScope() {
+        // The scopes ignored are the innermost ones, so they're closed first.
+        if (mIgnoredScopes > 0) {
+            mIgnoredScopes--;
+            return;
+        }
+        if (mDepth == 0) {
+            return;
+        }
+        Frame& frame = mFrames[mCurrent];
+        size_t idx = mOpenScopes[--mDepth];
+        glQueryCounter(frame.queries[2 * idx + 1], GL_TIMESTAMP);
+        frame.lastQuery = 2 * idx + 1;
+        frame.scopes[idx].cpuEndNs = tracing::nowNs();
+    }
+
+    void GpuProfiler::endFrame() {
+        if (!mRecording) {
+            return;
+        }
+        // Any scope left open ends with the frame.
+        while (mDepth > 0) {
+            endScope();
+        }
+        mFrames[mCurrent].pending = true;
+        mCurrent = (mCurrent + 1) % mNumFrames;
+        mRecording = false;
+    }
+
+    void GpuProfiler::format(char* str, size_t size) const {
+        size_t used = 0;
+        const char* separator = "";
+        int written = snprintf(str, size, "GPU/CPU ms:");
+        for (size_t idx = 0; idx < mNumResults && written >= 0; idx++) {
+            used += static_cast<size_t>(written);
+            written = 0;
+            const ScopeResult& scope = mResults[idx];
+            if (used >= size) {
+                continue;
+            }
+            written = snprintf(
+                str + used,
+                size - used,
+                "%s %s %.3f/%.3f",
+                separator,
+                scope.name,
+                scope.gpuMs,
+                scope.cpuMs);
+            separator = ",";
+        }
+    }
+}  // namespace profiling
@@ -0,0 +1,177 @@
+#ifndef RENDEER_GPU_PROFILER_HEADER
+#define RENDEER_GPU_PROFILER_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace profiling {
+    // Maximum number of scopes recorded in a single frame, and maximum nesting depth.
+    static const size_t kMaxScopes = 16;
+    static const size_t kMaxDepth = 8;
+
+    // Maximum number of frames whose queries are in flight.
+    static const size_t kMaxFrames = 4;
+
+    // Default number of frames in flight: the results of a frame are read two frames later, by
+    // which time the GPU is normally done with it.
+    static const size_t kDefaultFrames = 3;
+
+    // Timings of a scope of a completed frame.
+    struct ScopeResult {
+        // Name of the scope, as given to `beginScope`.
+        const char* name;
+        // Nesting depth of the scope, zero for the outermost scopes.
+        uint32_t depth;
+        // GPU timestamps, in nanoseconds, of the start and the end of the scope.
+        uint64_t gpuBeginNs;
+        uint64_t gpuEndNs;
+        // CPU timestamps, on the clock of `tracing::nowNs`, of the calls to `beginScope` and
+        // `endScope`.
+        uint64_t cpuBeginNs;
+        uint64_t cpuEndNs;
+        // Time spent by the GPU in the scope, and by the CPU issuing its commands.
+        double gpuMs;
+        double cpuMs;
+    };
+
+    /**
+     * @brief Profiler timing named scopes of a frame on the GPU with `GL_TIMESTAMP` queries, next
+     *        to the CPU time spent issuing them. Timestamps rather than `GL_TIME_ELAPSED` queries
+     *        let the scopes nest.
+     *
+     * The queries of each frame are only read back `numFrames - 1` frames later, once the GPU is
+     * normally done with them, and only if their results are available, so the profiler never
+     * waits on the GPU. A frame whose results are still pending is dropped instead.
+     *
+     * While tracing is started, the collected scopes are also recorded on the GPU track of the
+     * trace, their timestamps converted to the CPU clock by an offset between both clocks, measured
+     * with `glGetInteger64v(GL_TIMESTAMP)` and refreshed every few hundred frames.
+     *
+     * The OpenGL objects are not released on destruction, since the context may already be gone,
+     * `destroy` must be called explicitly.
+     */
+    class GpuProfiler {
+    public:
+        GpuProfiler() = default;
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        /**
+         * @brief Creates the query objects. Requires OpenGL 3.3.
+         *
+         * @param numFrames Number of frames in flight, between 2 and `kMaxFrames`.
+         * @return False if the number of frames is out of range.
+         */
+        bool init(size_t numFrames = kDefaultFrames);
+
+        /** @brief Deletes the query objects. */
+        void destroy();
+
+        /**
+         * @brief Starts recording a frame, after collecting the results of the oldest frame in
+         *        flight if they are available.
+         */
+        void beginFrame();
+
+        /**
+         * @brief Opens a scope, timing the commands issued until the matching `endScope`. Scopes
+         *        beyond `kMaxScopes` per frame or `kMaxDepth` deep are ignored.
+         *
+         * @param name Name of the scope, which must outlive the profiler, such as a literal.
+         */
+        void beginScope(const char* name);
+
+        /** @brief Closes the innermost open scope. */
+        void endScope();
+
+        /** @brief Ends the recording of the frame. */
+        void endFrame();
+
+        /** @brief Scopes of the latest frame whose results were collected, in opening order. */
+        const ScopeResult* results() const {
+            return mResults;
+        }
+
+        /** @brief Number of scopes in `results`, zero until the first results are collected. */
+        size_t numResults() const {
+            return mNumResults;
+        }
+
+        /** @brief Converts a GPU timestamp to the clock of `tracing::nowNs`. */
+        uint64_t toCpuNs(uint64_t gpuNs) const {
+            return static_cast<uint64_t>(static_cast<int64_t>(gpuNs) + mGpuToCpuNs);
+        }
+
+        /** @brief Number of frames dropped because their results weren't available in time. */
+        uint64_t numDroppedFrames() const {
+            return mNumDropped;
+        }
+
+        /**
+         * @brief Formats the GPU and CPU milliseconds of every scope of `results` on a single line,
+         *        such as `GPU/CPU ms: update 0.210/0.012, render 0.450/0.020`.
+         */
+        void format(char* str, size_t size) const;
+
+    private:
+        // Queries and scopes recorded in a frame.
+        struct Frame {
+            GLuint queries[2 * kMaxScopes];
+            ScopeResult scopes[kMaxScopes];
+            size_t numScopes;
+            // Index in `queries` of the last timestamp issued. Scopes nest, so it is the end of
+            // the outermost scope closed last, rather than the end of the last scope opened.
+            size_t lastQuery;
+            bool pending;
+        };
+
+        void calibrate();
+        void collect(Frame& frame);
+
+        Frame mFrames[kMaxFrames] = {};
+        size_t mNumFrames = 0;
+        size_t mCurrent = 0;
+        bool mRecording = false;
+
+        // Scopes of the current frame still open, innermost last.
+        size_t mOpenScopes[kMaxDepth] = {};
+        size_t mDepth = 0;
+        // Scopes opened beyond the limits, whose `endScope` must be ignored.
+        size_t mIgnoredScopes = 0;
+
+        ScopeResult mResults[kMaxScopes] = {};
+        size_t mNumResults = 0;
+        uint64_t mNumDropped = 0;
+
+        // Offset from the GPU clock to the CPU clock, and number of frames begun.
+        int64_t mGpuToCpuNs = 0;
+        uint64_t mFrameIndex = 0;
+    };
+
+    /**
+     * @brief Opens a GPU scope on construction and closes it on destruction, in the scope of a
+     *        block.
+     */
+    class GpuScope {
+    public:
+        GpuScope(GpuProfiler& profiler, const char* name) : mProfiler(profiler) {
+            mProfiler.beginScope(name);
+        }
+        ~GpuScope() {
+            mProfiler.endScope();
+        }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        GpuProfiler& mProfiler;
+    };
+}  // namespace profiling
+
+#endif  // RENDEER_GPU_PROFILER_HEADER
@@ -0,0 +1,248 @@
+#include "jobs.h"
+
+namespace jobs {
+    // Upper bound on the number of leaf ranges per thread in a single loop. Larger loops get their
+    // grain size increased, bounding the size of the job pool.
+    static const size_t kMaxLeavesPerThread = 64;
+
+    // Number of times an idle worker yields, looking for jobs, before going to sleep. Loops
+    // started in quick succession find the workers awake, while a pool left idle between frames
+    // doesn't keep any core busy.
+    static const size_t kMaxIdleSpins = 256;
+
+    // Upper bound on the number of threads of a pool per hardware thread, see `maxThreads`.
+    static const size_t kMaxThreadsPerHardwareThread = 4;
+
+    WorkStealingDeque::WorkStealingDeque()
+        : mTop(0)
+        , mBottom(0) {
+        for (int64_t idx = 0; idx < kCapacity; idx++) {
+            mSlots[idx].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    bool WorkStealingDeque::push(Job* job) {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed);
+        int64_t top = mTop.load(std::memory_order_acquire);
+        if (bottom - top >= kCapacity) {
+            return false;
+        }
+        mSlots[bottom & (kCapacity - 1)].store(job, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* WorkStealingDeque::pop() {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = mTop.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // Empty deque.
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = mSlots[bottom & (kCapacity - 1)].load(std::memory_order_acquire);
+        if (top == bottom) {
+            // Last job, race against the thieves for it.
+            if (!mTop.compare_exchange_strong(
+                    top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* WorkStealingDeque::steal() {
+        int64_t top = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = mBottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Job* job = mSlots[top & (kCapacity - 1)].load(std::memory_order_acquire);
+        if (!mTop.compare_exchange_strong(
+                top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    JobSystem::JobSystem(size_t numThreads)
+        : mJobPoolNext(0)
+        , mGrainSize(1)
+        , mRemaining(0)
+        , mQuit(false)
+        , mNumLoops(0) {
+        if (numThreads == 0) {
+            numThreads = hardwareThreads();
+        }
+
+        mDeques = std::vector<WorkStealingDeque>(numThreads);
+        mWorkers.reserve(numThreads - 1);
+        for (size_t threadIdx = 1; threadIdx < numThreads; threadIdx++) {
+            mWorkers.emplace_back(&JobSystem::workerLoop, this, threadIdx);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit.store(true);
+        }
+        mWakeCondition.notify_all();
+        for (std::thread& worker : mWorkers) {
+            worker.join();
+        }
+    }
+
+    size_t JobSystem::numThreads() const {
+        return mDeques.size();
+    }
+
+    size_t JobSystem::hardwareThreads() {
+        size_t numThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+        return numThreads > 0 ? numThreads : 1;
+    }
+
+    size_t JobSystem::maxThreads() {
+        return kMaxThreadsPerHardwareThread * hardwareThreads();
+    }
+
+    Job* JobSystem::findJob(size_t threadIdx) {
+        Job* job = mDeques[threadIdx].pop();
+        if (job) {
+            return job;
+        }
+
+        // Steal from the other threads, starting at the next one to spread the contention.
+        size_t numDeques = mDeques.size();
+        for (size_t offset = 1; offset < numDeques; offset++) {
+            job = mDeques[(threadIdx + offset) % numDeques].steal();
+            if (job) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::execute(Job* job, size_t threadIdx) {
+        size_t begin = job->begin;
+        size_t end = job->end;
+
+        // Keep the lower half and expose the upper half to thieves, until the range is small.
+        while (end - begin > mGrainSize) {
+            size_t jobIdx = mJobPoolNext.fetch_add(1, std::memory_order_relaxed);
+            if (jobIdx >= mJobPool.size()) {
+                break;
+            }
+
+            size_t mid = begin + (end - begin) / 2;
+            Job* upper = &mJobPool[jobIdx];
+            upper->fn = job->fn;
+            upper->ctx = job->ctx;
+            upper->begin = mid;
+            upper->end = end;
+            if (!mDeques[threadIdx].push(upper)) {
+                break;
+            }
+            end = mid;
+        }
+
+        job->fn(job->ctx, begin, end);
+        mRemaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+    }
+
+    void JobSystem::workerLoop(size_t threadIdx) {
+        uint64_t numLoopsSeen = 0;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            numLoopsSeen = mNumLoops;
+        }
+
+        size_t numIdleSpins = 0;
+        while (!mQuit.load(std::memory_order_relaxed)) {
+            Job* job = findJob(threadIdx);
+            if (job) {
+                execute(job, threadIdx);
+                numIdleSpins = 0;
+                continue;
+            }
+
+            if (numIdleSpins < kMaxIdleSpins) {
+                // Other threads may still split their ranges, or a new loop may start shortly.
+                numIdleSpins++;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Sleep until a loop starts after the last one seen, which returns at once if one
+            // started while spinning. The tail of a running loop is left to the awake threads.
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeCondition.wait(lock, [this, numLoopsSeen]() {
+                return mQuit.load(std::memory_order_relaxed) || mNumLoops != numLoopsSeen;
+            });
+            numLoopsSeen = mNumLoops;
+            numIdleSpins = 0;
+        }
+    }
+
+    void JobSystem::parallelFor(
+        size_t begin,
+        size_t end,
+        size_t grainSize,
+        RangeFn fn,
+        void* ctx) {
+        if (end <= begin) {
+            return;
+        }
+        size_t numItems = end - begin;
+        size_t maxLeaves = kMaxLeavesPerThread * numThreads();
+        mGrainSize = grainSize > 0 ? grainSize : 1;
+        if (numItems / mGrainSize > maxLeaves) {
+            mGrainSize = (numItems + maxLeaves - 1) / maxLeaves;
+        }
+
+        // Single threaded pool, or nothing to split.
+        if (mWorkers.empty() || numItems <= mGrainSize) {
+            fn(ctx, begin, end);
+            return;
+        }
+
+        // Each split creates one job, and there are at most two leaves per grain.
+        size_t maxLeafCount = 2 * ((numItems + mGrainSize - 1) / mGrainSize);
+        if (mJobPool.size() < maxLeafCount + 1) {
+            mJobPool.resize(maxLeafCount + 1);
+        }
+        mJobPoolNext.store(1, std::memory_order_relaxed);
+
+        Job* root = &mJobPool[0];
+        root->fn = fn;
+        root->ctx = ctx;
+        root->begin = begin;
+        root->end = end;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRemaining.store(numItems, std::memory_order_release);
+            mNumLoops++;
+        }
+        mWakeCondition.notify_all();
+
+        // The calling thread works on the loop until every item has been processed.
+        execute(root, 0);
+        while (mRemaining.load(std::memory_order_acquire) != 0) {
+            Job* job = findJob(0);
+            if (job) {
+                execute(job, 0);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}  // namespace jobs
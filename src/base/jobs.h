@@ -0,0 +1,137 @@
+#ifndef RENDEER_JOBS_HEADER
+#define RENDEER_JOBS_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jobs {
+    // Function processing the half-open range of items `[begin, end)`.
+    using RangeFn = void (*)(void* ctx, size_t begin, size_t end);
+
+    // Unit of work: a range of items yet to be processed by `fn`.
+    struct Job {
+        RangeFn fn;
+        void* ctx;
+        size_t begin;
+        size_t end;
+    };
+
+    /**
+     * @brief Bounded Chase-Lev work-stealing deque. The owner thread pushes and pops jobs at the
+     *        bottom, while any other thread may steal from the top.
+     */
+    class WorkStealingDeque {
+    public:
+        // Maximum number of jobs held at once, must be a power of two.
+        static const int64_t kCapacity = 256;
+
+        WorkStealingDeque();
+
+        /** @brief Owner only. Returns false if the deque is full. */
+        bool push(Job* job);
+
+        /** @brief Owner only. Returns null if the deque is empty. */
+        Job* pop();
+
+        /** @brief Any thread. Returns null if the deque is empty or the steal lost a race. */
+        Job* steal();
+
+    private:
+        std::atomic<int64_t> mTop;
+        std::atomic<int64_t> mBottom;
+        std::atomic<Job*> mSlots[kCapacity];
+    };
+
+    /**
+     * @brief Pool of worker threads, each owning a work-stealing deque, executing parallel loops
+     *        over ranges of items. The thread calling `parallelFor` takes part in the work.
+     *
+     * Ranges are recursively halved: each thread keeps working on the lower half of its range and
+     * pushes the upper half onto its deque, where idle threads can steal it. Workers finding no job
+     * yield for a bounded number of attempts, then sleep until the next loop starts. `parallelFor`
+     * is not reentrant and must only be called from the thread that created the pool.
+     */
+    class JobSystem {
+    public:
+        /**
+         * @brief Spawns the worker threads.
+         *
+         * @param numThreads Total number of threads, including the caller. Zero selects the
+         *        number of hardware threads.
+         */
+        explicit JobSystem(size_t numThreads = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        /** @brief Total number of threads executing jobs, including the caller. */
+        size_t numThreads() const;
+
+        /** @brief Number of hardware threads of the machine, at least one. */
+        static size_t hardwareThreads();
+
+        /**
+         * @brief Largest number of threads a pool should be created with, four per hardware
+         *        thread, beyond which more threads only add contention.
+         */
+        static size_t maxThreads();
+
+        /**
+         * @brief Calls `fn(ctx, begin, end)` over disjoint sub-ranges covering `[begin, end)`, and
+         *        returns once all of them have been processed.
+         *
+         * @param begin First item of the range.
+         * @param end One past the last item of the range.
+         * @param grainSize Ranges with at most this many items are not split any further.
+         * @param fn Function processing a sub-range.
+         * @param ctx Opaque pointer forwarded to `fn`.
+         */
+        void parallelFor(size_t begin, size_t end, size_t grainSize, RangeFn fn, void* ctx);
+
+        /** @brief Convenience overload for callables with signature `void(size_t, size_t)`. */
+        template <typename Fn>
+        void parallelFor(size_t begin, size_t end, size_t grainSize, Fn&& fn) {
+            using FnType = std::remove_reference_t<Fn>;
+            parallelFor(
+                begin,
+                end,
+                grainSize,
+                [](void* ctx, size_t rangeBegin, size_t rangeEnd) {
+                    (*static_cast<FnType*>(ctx))(rangeBegin, rangeEnd);
+                },
+                const_cast<void*>(static_cast<const void*>(&fn)));
+        }
+
+    private:
+        void workerLoop(size_t threadIdx);
+        Job* findJob(size_t threadIdx);
+        void execute(Job* job, size_t threadIdx);
+
+        std::vector<std::thread> mWorkers;
+        // One deque per thread, index zero belonging to the thread that owns the pool.
+        std::vector<WorkStealingDeque> mDeques;
+
+        // Storage for the jobs created while splitting the range of the current loop.
+        std::vector<Job> mJobPool;
+        std::atomic<size_t> mJobPoolNext;
+        size_t mGrainSize;
+
+        // Number of items of the current loop that were not processed yet.
+        std::atomic<size_t> mRemaining;
+        std::atomic<bool> mQuit;
+        // Number of loops started, guarded by `mMutex`, so that parked workers wake up for the
+        // next loop only.
+        uint64_t mNumLoops;
+        std::mutex mMutex;
+        std::condition_variable mWakeCondition;
+    };
+}  // namespace jobs
+
+#endif  // RENDEER_JOBS_HEADER
@@ -0,0 +1,290 @@
+#ifndef RENDEER_LINALG_HEADER
+#define RENDEER_LINALG_HEADER
+
+#include <math.h>
+#include <stddef.h>
+
+// Small linear algebra module. Matrices are stored in column-major order, so that their `m` member
+// can be uploaded as-is with `glUniformMatrix*fv` and `transpose` set to `GL_FALSE`. Everything not
+// requiring trigonometric functions is `constexpr`.
+namespace linalg {
+    struct Vec3 {
+        float x;
+        float y;
+        float z;
+    };
+
+    struct Vec4 {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
+
+    constexpr Vec3 operator+(Vec3 a, Vec3 b) {
+        return Vec3{a.x + b.x, a.y + b.y, a.z + b.z};
+    }
+
+    constexpr Vec3 operator-(Vec3 a, Vec3 b) {
+        return Vec3{a.x - b.x, a.y - b.y, a.z - b.z};
+    }
+
+    constexpr Vec3 operator*(Vec3 v, float s) {
+        return Vec3{v.x * s, v.y * s, v.z * s};
+    }
+
+    constexpr float dot(Vec3 a, Vec3 b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    constexpr Vec3 cross(Vec3 a, Vec3 b) {
+        return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    inline Vec3 normalize(Vec3 v) {
+        return v * (1.0F / sqrtf(dot(v, v)));
+    }
+
+    /***********
+     * 3x3 matrices.
+     ***********/
+
+    struct Mat3 {
+        float m[9];
+
+        constexpr float operator()(size_t row, size_t col) const {
+            return m[3 * col + row];
+        }
+    };
+
+    constexpr Mat3 identity3() {
+        return Mat3{{1.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 1.0F}};
+    }
+
+    /** @brief Builds a matrix from its entries written in reading order, row by row. */
+    constexpr Mat3 mat3FromRows(
+        float m00,
+        float m01,
+        float m02,
+        float m10,
+        float m11,
+        float m12,
+        float m20,
+        float m21,
+        float m22) {
+        return Mat3{{m00, m10, m20, m01, m11, m21, m02, m12, m22}};
+    }
+
+    constexpr Mat3 transpose(const Mat3& a) {
+        return mat3FromRows(
+            a.m[0], a.m[1], a.m[2], a.m[3], a.m[4], a.m[5], a.m[6], a.m[7], a.m[8]);
+    }
+
+    constexpr Mat3 operator*(const Mat3& a, const Mat3& b) {
+        Mat3 r{};
+        for (size_t col = 0; col < 3; col++) {
+            for (size_t row = 0; row < 3; row++) {
+                float sum = 0.0F;
+                for (size_t k = 0; k < 3; k++) {
+                    sum += a(row, k) * b(k, col);
+                }
+                r.m[3 * col + row] = sum;
+            }
+        }
+        return r;
+    }
+
+    constexpr Vec3 operator*(const Mat3& a, Vec3 v) {
+        return Vec3{
+            a(0, 0) * v.x + a(0, 1) * v.y + a(0, 2) * v.z,
+            a(1, 0) * v.x + a(1, 1) * v.y + a(1, 2) * v.z,
+            a(2, 0) * v.x + a(2, 1) * v.y + a(2, 2) * v.z,
+        };
+    }
+
+    /** @brief Rotation by `angle` radians around the x axis. */
+    inline Mat3 rotationX(float angle) {
+        float c = cosf(angle);
+        float s = sinf(angle);
+        return mat3FromRows(1.0F, 0.0F, 0.0F, 0.0F, c, -s, 0.0F, s, c);
+    }
+
+    /** @brief Rotation by `angle` radians around the y axis. */
+    inline Mat3 rotationY(float angle) {
+        float c = cosf(angle);
+        float s = sinf(angle);
+        return mat3FromRows(c, 0.0F, s, 0.0F, 1.0F, 0.0F, -s, 0.0F, c);
+    }
+
+    /** @brief Rotation by `angle` radians around the z axis. */
+    inline Mat3 rotationZ(float angle) {
+        float c = cosf(angle);
+        float s = sinf(angle);
+        return mat3FromRows(c, -s, 0.0F, s, c, 0.0F, 0.0F, 0.0F, 1.0F);
+    }
+
+    /***********
+     * 4x4 matrices.
+     ***********/
+
+    struct Mat4 {
+        float m[16];
+
+        constexpr float operator()(size_t row, size_t col) const {
+            return m[4 * col + row];
+        }
+    };
+
+    constexpr Mat4 identity4() {
+        return Mat4{{
+            // clang-format off
+            1.0F, 0.0F, 0.0F, 0.0F,
+            0.0F, 1.0F, 0.0F, 0.0F,
+            0.0F, 0.0F, 1.0F, 0.0F,
+            0.0F, 0.0F, 0.0F, 1.0F,
+            // clang-format on
+        }};
+    }
+
+    constexpr Mat4 operator*(const Mat4& a, const Mat4& b) {
+        Mat4 r{};
+        for (size_t col = 0; col < 4; col++) {
+            for (size_t row = 0; row < 4; row++) {
+                float sum = 0.0F;
+                for (size_t k = 0; k < 4; k++) {
+                    sum += a(row, k) * b(k, col);
+                }
+                r.m[4 * col + row] = sum;
+            }
+        }
+        return r;
+    }
+
+    constexpr Vec4 operator*(const Mat4& a, Vec4 v) {
+        return Vec4{
+            a(0, 0) * v.x + a(0, 1) * v.y + a(0, 2) * v.z + a(0, 3) * v.w,
+            a(1, 0) * v.x + a(1, 1) * v.y + a(1, 2) * v.z + a(1, 3) * v.w,
+            a(2, 0) * v.x + a(2, 1) * v.y + a(2, 2) * v.z + a(2, 3) * v.w,
+            a(3, 0) * v.x + a(3, 1) * v.y + a(3, 2) * v.z + a(3, 3) * v.w,
+        };
+    }
+
+    /** @brief Embeds a linear map into the upper left block of a homogeneous transform. */
+    constexpr Mat4 mat4FromMat3(const Mat3& a) {
+        return Mat4{{
+            // clang-format off
+            a.m[0], a.m[1], a.m[2], 0.0F,
+            a.m[3], a.m[4], a.m[5], 0.0F,
+            a.m[6], a.m[7], a.m[8], 0.0F,
+            0.0F,   0.0F,   0.0F,   1.0F,
+            // clang-format on
+        }};
+    }
+
+    constexpr Mat4 translation(Vec3 t) {
+        return Mat4{{
+            // clang-format off
+            1.0F, 0.0F, 0.0F, 0.0F,
+            0.0F, 1.0F, 0.0F, 0.0F,
+            0.0F, 0.0F, 1.0F, 0.0F,
+            t.x,  t.y,  t.z,  1.0F,
+            // clang-format on
+        }};
+    }
+
+    constexpr Mat4 scaling(Vec3 s) {
+        return Mat4{{
+            // clang-format off
+            s.x,  0.0F, 0.0F, 0.0F,
+            0.0F, s.y,  0.0F, 0.0F,
+            0.0F, 0.0F, s.z,  0.0F,
+            0.0F, 0.0F, 0.0F, 1.0F,
+            // clang-format on
+        }};
+    }
+
+    /**
+     * @brief Perspective projection of a camera looking down the negative z axis.
+     *
+     * @param xScale Scale of the x coordinates, the frustum scale corrected by the aspect ratio.
+     * @param yScale Scale of the y coordinates, the frustum scale.
+     * @param zNear Distance to the near plane.
+     * @param zFar Distance to the far plane.
+     */
+    constexpr Mat4 perspective(float xScale, float yScale, float zNear, float zFar) {
+        return Mat4{{
+            // clang-format off
+            xScale, 0.0F,   0.0F,                                   0.0F,
+            0.0F,   yScale, 0.0F,                                   0.0F,
+            0.0F,   0.0F,   (zNear + zFar) / (zNear - zFar),        -1.0F,
+            0.0F,   0.0F,   (2.0F * zNear * zFar) / (zNear - zFar), 0.0F,
+            // clang-format on
+        }};
+    }
+
+    /***********
+     * Quaternions.
+     ***********/
+
+    // Quaternion `w + xi + yj + zk`. Unit quaternions represent rotations.
+    struct Quat {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
+
+    constexpr Quat identityQuat() {
+        return Quat{0.0F, 0.0F, 0.0F, 1.0F};
+    }
+
+    /** @brief Hamilton product, `a * b` rotates by `b` and then by `a`. */
+    constexpr Quat operator*(Quat a, Quat b) {
+        return Quat{
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        };
+    }
+
+    constexpr Quat conjugate(Quat q) {
+        return Quat{-q.x, -q.y, -q.z, q.w};
+    }
+
+    inline Quat normalize(Quat q) {
+        float invLen = 1.0F / sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        return Quat{q.x * invLen, q.y * invLen, q.z * invLen, q.w * invLen};
+    }
+
+    /** @brief Rotation by `angle` radians around the unit vector `axis`. */
+    inline Quat quatFromAxisAngle(Vec3 axis, float angle) {
+        float s = sinf(0.5F * angle);
+        return Quat{axis.x * s, axis.y * s, axis.z * s, cosf(0.5F * angle)};
+    }
+
+    /** @brief Rotation matrix of a unit quaternion. */
+    constexpr Mat3 toMat3(Quat q) {
+        float xx = q.x * q.x;
+        float yy = q.y * q.y;
+        float zz = q.z * q.z;
+        float xy = q.x * q.y;
+        float xz = q.x * q.z;
+        float yz = q.y * q.z;
+        float wx = q.w * q.x;
+        float wy = q.w * q.y;
+        float wz = q.w * q.z;
+        return mat3FromRows(
+            1.0F - 2.0F * (yy + zz),
+            2.0F * (xy - wz),
+            2.0F * (xz + wy),
+            2.0F * (xy + wz),
+            1.0F - 2.0F * (xx + zz),
+            2.0F * (yz - wx),
+            2.0F * (xz - wy),
+            2.0F * (yz + wx),
+            1.0F - 2.0F * (xx + yy));
+    }
+}  // namespace linalg
+
+#endif  // RENDEER_LINALG_HEADER
@@ -0,0 +1,287 @@
+#include "mesh.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "utils.h"
+
+namespace mesh {
+    // Marks empty hash table slots and vertices not yet remapped.
+    static const uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+    // Parameters of the vertex scores of Forsyth's algorithm: size of the modelled LRU cache, score
+    // of the vertices of the last triangle, decay of the score with the position in the cache, and
+    // boost of the vertices with few triangles left, so that they are finished off quickly.
+    static const size_t kForsythCacheSize = 32;
+    static const float kLastTriangleScore = 0.75F;
+    static const float kCacheDecayPower = 1.5F;
+    static const float kValenceBoostScale = 2.0F;
+    static const float kValenceBoostPower = 0.5F;
+
+    size_t weldVertices(
+        const void* vertices,
+        size_t numVertices,
+        size_t vertexSize,
+        uint32_t* indices,
+        void* uniqueVertices) {
+        const uint8_t* src = static_cast<const uint8_t*>(vertices);
+        uint8_t* dst = static_cast<uint8_t*>(uniqueVertices);
+
+        // Open addressing table of indices into `dst`, at most half full.
+        size_t capacity = 16;
+        while (capacity < 2 * numVertices) {
+            capacity *= 2;
+        }
+        uint32_t* table = new uint32_t[capacity];
+        for (size_t idx = 0; idx < capacity; idx++) {
+            table[idx] = kInvalidIndex;
+        }
+
+        size_t numUnique = 0;
+        for (size_t vtx = 0; vtx < numVertices; vtx++) {
+            const uint8_t* vertex = src + vtx * vertexSize;
+            uint64_t hash = utils::hashBytes(utils::kFnvOffsetBasis, vertex, vertexSize);
+            size_t slot = static_cast<size_t>(hash) & (capacity - 1);
+            while (table[slot] != kInvalidIndex &&
+                   memcmp(dst + table[slot] * vertexSize, vertex, vertexSize) != 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (table[slot] == kInvalidIndex) {
+                memcpy(dst + numUnique * vertexSize, vertex, vertexSize);
+                table[slot] = static_cast<uint32_t>(numUnique++);
+            }
+            indices[vtx] = table[slot];
+        }
+
+        delete[] table;
+        return numUnique;
+    }
+
+    /**
+     * @brief Score of a vertex in Forsyth's algorithm, the triangle with the highest sum of vertex
+     *        scores being emitted next.
+     *
+     * @param cachePos Position of the vertex in the modelled cache, negative if it isn't cached.
+     * @param valence Number of triangles still to be emitted using the vertex.
+     */
+    static float vertexScore(int cachePos, uint32_t valence) {
+        if (valence == 0) {
+            return -1.0F;
+        }
+
+        float score = 0.0F;
+        if (cachePos >= 0) {
+            if (cachePos < 3) {
+                // The vertices of the last triangle get a fixed score, so that the algorithm
+                // doesn't favour reusing them over the others in the cache.
+                score = kLastTriangleScore;
+            } else {
+                float scaler = 1.0F / static_cast<float>(kForsythCacheSize - 3);
+                score = powf(1.0F - static_cast<float>(cachePos - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        return score + kValenceBoostScale * powf(static_cast<float>(valence), -kValenceBoostPower);
+    }
+
+    void optimizeVertexCache(uint32_t* indices, size_t numIndices, size_t numVertices) {
+        size_t numTriangles = numIndices / 3;
+        if (numTriangles == 0) {
+            return;
+        }
+
+        // Triangles using each vertex: `valence[v]` live triangles from `adjacency[adjOffsets[v]]`.
+        uint32_t* valence = new uint32_t[numVertices]();
+        for (size_t idx = 0; idx < numIndices; idx++) {
+            valence[indices[idx]]++;
+        }
+        uint32_t* adjOffsets = new uint32_t[numVertices];
+        uint32_t offset = 0;
+        for (size_t vtx = 0; vtx < numVertices; vtx++) {
+            adjOffsets[vtx] = offset;
+            offset += valence[vtx];
+            valence[vtx] = 0;
+        }
+        uint32_t* adjacency = new uint32_t[numIndices];
+        for (size_t idx = 0; idx < numIndices; idx++) {
+            uint32_t vtx = indices[idx];
+            adjacency[adjOffsets[vtx] + valence[vtx]++] = static_cast<uint32_t>(idx / 3);
+        }
+
+        int* cachePos = new int[numVertices];
+        float* scores = new float[numVertices];
+        for (size_t vtx = 0; vtx < numVertices; vtx++) {
+            cachePos[vtx] = -1;
+            scores[vtx] = vertexScore(-1, valence[vtx]);
+        }
+
+        float* triScores = new float[numTriangles];
+        bool* emitted = new bool[numTriangles]();
+        size_t best = 0;
+        for (size_t tri = 0; tri < numTriangles; tri++) {
+            const uint32_t* corners = indices + 3 * tri;
+            triScores[tri] = scores[corners[0]] + scores[corners[1]] + scores[corners[2]];
+            if (triScores[tri] > triScores[best]) {
+                best = tri;
+            }
+        }
+
+        uint32_t* output = new uint32_t[numIndices];
+        uint32_t cache[kForsythCacheSize + 3];
+        size_t cacheCount = 0;
+        size_t nextUnemitted = 0;
+        bool hasBest = true;
+
+        for (size_t outTri = 0; outTri < numTriangles; outTri++) {
+            if (!hasBest) {
+                // None of the cached vertices has triangles left, restart from anywhere.
+                while (emitted[nextUnemitted]) {
+                    nextUnemitted++;
+                }
+                best = nextUnemitted;
+            }
+
+            const uint32_t* corners = indices + 3 * best;
+            memcpy(output + 3 * outTri, corners, 3 * sizeof(uint32_t));
+            emitted[best] = true;
+
+            // Remove the triangle from the live triangles of its vertices.
+            for (size_t corner = 0; corner < 3; corner++) {
+                uint32_t vtx = corners[corner];
+                uint32_t* live = adjacency + adjOffsets[vtx];
+                for (uint32_t idx = 0; idx < valence[vtx]; idx++) {
+                    if (live[idx] == best) {
+                        live[idx] = live[valence[vtx] - 1];
+                        valence[vtx]--;
+                        break;
+                    }
+                }
+            }
+
+            // The vertices of the triangle move to the front of the cache.
+            uint32_t newCache[kForsythCacheSize + 3];
+            size_t newCount = 0;
+            for (size_t corner = 0; corner < 3; corner++) {
+                uint32_t vtx = corners[corner];
+                bool duplicate = false;
+                for (size_t idx = 0; idx < newCount; idx++) {
+                    duplicate = duplicate || newCache[idx] == vtx;
+                }
+                if (!duplicate) {
+                    newCache[newCount++] = vtx;
+                }
+            }
+            for (size_t idx = 0; idx < cacheCount; idx++) {
+                uint32_t vtx = cache[idx];
+                if (vtx != corners[0] && vtx != corners[1] && vtx != corners[2]) {
+                    newCache[newCount++] = vtx;
+                }
+            }
+
+            // Vertices pushed out of the cache only keep their valence boost.
+            for (size_t idx = kForsythCacheSize; idx < newCount; idx++) {
+                uint32_t vtx = newCache[idx];
+                cachePos[vtx] = -1;
+                scores[vtx] = vertexScore(-1, valence[vtx]);
+            }
+            cacheCount = newCount < kForsythCacheSize ? newCount : kForsythCacheSize;
+            for (size_t idx = 0; idx < cacheCount; idx++) {
+                uint32_t vtx = newCache[idx];
+                cache[idx] = vtx;
+                cachePos[vtx] = static_cast<int>(idx);
+                scores[vtx] = vertexScore(static_cast<int>(idx), valence[vtx]);
+            }
+
+            // Only the triangles of cached vertices changed score, the next one is among them.
+            hasBest = false;
+            float bestScore = 0.0F;
+            for (size_t idx = 0; idx < cacheCount; idx++) {
+                uint32_t vtx = cache[idx];
+                const uint32_t* live = adjacency + adjOffsets[vtx];
+                for (uint32_t adj = 0; adj < valence[vtx]; adj++) {
+                    uint32_t tri = live[adj];
+                    const uint32_t* triCorners = indices + 3 * tri;
+                    triScores[tri] =
+                        scores[triCorners[0]] + scores[triCorners[1]] + scores[triCorners[2]];
+                    if (!hasBest || triScores[tri] > bestScore) {
+                        best = tri;
+                        bestScore = triScores[tri];
+                        hasBest = true;
+                    }
+                }
+            }
+        }
+
+        memcpy(indices, output, 3 * numTriangles * sizeof(uint32_t));
+
+        delete[] output;
+        delete[] emitted;
+        delete[] triScores;
+        delete[] scores;
+        delete[] cachePos;
+        delete[] adjacency;
+        delete[] adjOffsets;
+        delete[] valence;
+    }
+
+    size_t optimizeVertexFetch(
+        void* vertices,
+        uint32_t* indices,
+        size_t numIndices,
+        size_t numVertices,
+        size_t vertexSize) {
+        uint8_t* dst = static_cast<uint8_t*>(vertices);
+        uint8_t* src = new uint8_t[numVertices * vertexSize];
+        memcpy(src, dst, numVertices * vertexSize);
+
+        uint32_t* remap = new uint32_t[numVertices];
+        for (size_t vtx = 0; vtx < numVertices; vtx++) {
+            remap[vtx] = kInvalidIndex;
+        }
+
+        uint32_t numFetched = 0;
+        for (size_t idx = 0; idx < numIndices; idx++) {
+            uint32_t vtx = indices[idx];
+            if (remap[vtx] == kInvalidIndex) {
+                memcpy(dst + numFetched * vertexSize, src + vtx * vertexSize, vertexSize);
+                remap[vtx] = numFetched++;
+            }
+            indices[idx] = remap[vtx];
+        }
+
+        delete[] remap;
+        delete[] src;
+        return numFetched;
+    }
+
+    float computeACMR(const uint32_t* indices, size_t numIndices, size_t cacheSize) {
+        size_t numTriangles = numIndices / 3;
+        if (numTriangles == 0 || cacheSize == 0) {
+            return 0.0F;
+        }
+
+        // FIFO of the last transformed vertices, `head` pointing to the oldest entry.
+        uint32_t* fifo = new uint32_t[cacheSize];
+        for (size_t idx = 0; idx < cacheSize; idx++) {
+            fifo[idx] = kInvalidIndex;
+        }
+        size_t head = 0;
+        size_t misses = 0;
+        for (size_t idx = 0; idx < 3 * numTriangles; idx++) {
+            bool hit = false;
+            for (size_t entry = 0; entry < cacheSize; entry++) {
+                if (fifo[entry] == indices[idx]) {
+                    hit = true;
+                    break;
+                }
+            }
+            if (!hit) {
+                fifo[head] = indices[idx];
+                head = (head + 1) % cacheSize;
+                misses++;
+            }
+        }
+
+        delete[] fifo;
+        return static_cast<float>(misses) / static_cast<float>(numTriangles);
+    }
+}  // namespace mesh
@@ -0,0 +1,77 @@
+#ifndef RENDEER_MESH_HEADER
+#define RENDEER_MESH_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Processing of indexed triangle lists, making the most of the post-transform vertex cache and of
+// the vertex fetch. Vertices are opaque blobs of `vertexSize` bytes, so that any vertex format can
+// be processed, two vertices being equal if all of their bytes are.
+namespace mesh {
+    // Size of the FIFO post-transform cache simulated by `computeACMR`, typical of desktop GPUs.
+    static const size_t kSimulatedCacheSize = 16;
+
+    /**
+     * @brief Welds identical vertices of an unindexed triangle list, producing an index buffer.
+     *
+     * @param vertices Unindexed vertices, each group of three forming a triangle.
+     * @param numVertices Number of vertices, which is also the number of indices produced.
+     * @param vertexSize Size in bytes of each vertex.
+     * @param indices Receives `numVertices` indices into `uniqueVertices`.
+     * @param uniqueVertices Receives the unique vertices in order of first appearance, it must be
+     *        large enough to hold `numVertices` vertices.
+     * @return Number of unique vertices.
+     */
+    size_t weldVertices(
+        const void* vertices,
+        size_t numVertices,
+        size_t vertexSize,
+        uint32_t* indices,
+        void* uniqueVertices);
+
+    /**
+     * @brief Reorders the triangles of an indexed triangle list so that consecutive triangles
+     *        reuse the vertices recently transformed, following Tom Forsyth's "Linear-speed vertex
+     *        cache optimisation". The vertices themselves are left untouched.
+     *
+     * @param indices Indices of the triangles, reordered in place.
+     * @param numIndices Number of indices, a multiple of three.
+     * @param numVertices Number of vertices referenced by the indices.
+     */
+    void optimizeVertexCache(uint32_t* indices, size_t numIndices, size_t numVertices);
+
+    /**
+     * @brief Reorders the vertices in the order they are first referenced by the indices, so that
+     *        the vertex fetch reads memory sequentially, and remaps the indices accordingly.
+     *        Vertices not referenced by any index are dropped.
+     *
+     * @param vertices Vertices, reordered in place.
+     * @param indices Indices, remapped in place.
+     * @param numIndices Number of indices.
+     * @param numVertices Number of vertices.
+     * @param vertexSize Size in bytes of each vertex.
+     * @return Number of vertices left.
+     */
+    size_t optimizeVertexFetch(
+        void* vertices,
+        uint32_t* indices,
+        size_t numIndices,
+        size_t numVertices,
+        size_t vertexSize);
+
+    /**
+     * @brief Average cache miss ratio: number of vertex shader invocations per triangle with a FIFO
+     *        post-transform cache. It ranges from 3, every vertex being transformed again, down to
+     *        about 0.5 for large regular meshes.
+     *
+     * @param indices Indices of the triangles.
+     * @param numIndices Number of indices, a multiple of three.
+     * @param cacheSize Number of entries of the simulated cache.
+     */
+    float computeACMR(
+        const uint32_t* indices,
+        size_t numIndices,
+        size_t cacheSize = kSimulatedCacheSize);
+}  // namespace mesh
+
+#endif  // RENDEER_MESH_HEADER
@@ -0,0 +1,246 @@
+#include "programCache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fileView.h"
+#include "trace.h"
+#include "utils.h"
+
+namespace shaders {
+    // Identifies the files of the cache ("RDPB"), and the version of their layout.
+    static const uint32_t kCacheMagic = 0x42504452;
+    static const uint32_t kCacheVersion = 1;
+
+    // Header preceding the program binary in each cache file.
+    struct CacheEntryHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t binaryFormat;
+        uint32_t binarySize;
+    };
+
+    /** @brief Hashes a string, including its terminator so that concatenations don't collide. */
+    static uint64_t hashString(uint64_t hash, const char* str) {
+        if (!str) {
+            str = "";
+        }
+        return utils::hashBytes(hash, str, strlen(str) + 1);
+    }
+
+    bool ProgramCache::init(const char* directory) {
+        mEnabled = false;
+
+        GLint numFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        if (numFormats <= 0) {
+            fprintf(stderr, "The driver supports no program binary format, cache disabled.\n");
+            return false;
+        }
+
+        if (strlen(directory) + 32 >= sizeof(mDirectory)) {
+            fprintf(stderr, "Program cache directory path is too long: %s.\n", directory);
+            return false;
+        }
+        if (mkdir(directory, 0755) == -1 && errno != EEXIST) {
+            fprintf(
+                stderr,
+                "Couldn't create program cache directory %s: %s.\n",
+                directory,
+                strerror(errno));
+            return false;
+        }
+        snprintf(mDirectory, sizeof(mDirectory), "%s", directory);
+
+        mDriverHash =
+            utils::hashBytes(utils::kFnvOffsetBasis, &kCacheVersion, sizeof(kCacheVersion));
+        const GLenum driverStrings[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for (GLenum name : driverStrings) {
+            mDriverHash = hashString(mDriverHash, reinterpret_cast<const char*>(glGetString(name)));
+        }
+
+        mEnabled = true;
+        return true;
+    }
+
+    uint64_t ProgramCache::computeKey(const ProgramDesc& desc) const {
+        uint64_t hash = mDriverHash;
+        for (size_t idx = 0; idx < desc.numSources; idx++) {
+            hash = utils::hashBytes(hash, &desc.sources[idx].type, sizeof(desc.sources[idx].type));
+            hash = hashString(hash, desc.sources[idx].source);
+        }
+        for (size_t idx = 0; idx < desc.numFeedbackVaryings; idx++) {
+            hash = hashString(hash, desc.feedbackVaryings[idx]);
+        }
+        if (desc.numFeedbackVaryings > 0) {
+            hash = utils::hashBytes(
+                hash, &desc.feedbackBufferMode, sizeof(desc.feedbackBufferMode));
+        }
+        return hash;
+    }
+
+    void ProgramCache::entryPath(uint64_t key, char* path, size_t pathSize) const {
+        snprintf(
+            path, pathSize, "%s/%016llx.bin", mDirectory, static_cast<unsigned long long>(key));
+    }
+
+    bool ProgramCache::load(uint64_t key, GLuint& program) const {
+        if (!mEnabled) {
+            return false;
+        }
+
+        char path[sizeof(mDirectory) + 32];
+        entryPath(key, path, sizeof(path));
+        if (access(path, R_OK) != 0) {
+            return false;
+        }
+
+        utils::FileView entry;
+        if (!entry.open(path)) {
+            return false;
+        }
+        CacheEntryHeader header;
+        if (entry.size() < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, entry.data(), sizeof(header));
+        if (header.magic != kCacheMagic || header.version != kCacheVersion || header.key != key ||
+            entry.size() != sizeof(header) + header.binarySize) {
+            fprintf(stderr, "Ignoring malformed program cache entry %s.\n", path);
+            return false;
+        }
+
+        program = glCreateProgram();
+        glProgramBinary(
+            program,
+            header.binaryFormat,
+            entry.data() + sizeof(header),
+            static_cast<GLsizei>(header.binarySize));
+
+        // The driver may reject binaries it produced itself, for instance after an update that kept
+        // the same version string. Fall back to compiling from source in that case.
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE) {
+            glDeleteProgram(program);
+            program = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void ProgramCache::store(uint64_t key, GLuint program) const {
+        if (!mEnabled) {
+            return;
+        }
+
+        GLint binarySize = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+        if (binarySize <= 0) {
+            return;
+        }
+
+        size_t entrySize = sizeof(CacheEntryHeader) + static_cast<size_t>(binarySize);
+        uint8_t* entry = static_cast<uint8_t*>(malloc(entrySize));
+        if (!entry) {
+            return;
+        }
+
+        CacheEntryHeader header;
+        header.magic = kCacheMagic;
+        header.version = kCacheVersion;
+        header.key = key;
+        GLenum binaryFormat = 0;
+        GLsizei writtenSize = 0;
+        glGetProgramBinary(
+            program, binarySize, &writtenSize, &binaryFormat, entry + sizeof(CacheEntryHeader));
+        header.binaryFormat = binaryFormat;
+        header.binarySize = static_cast<uint32_t>(writtenSize);
+        memcpy(entry, &header, sizeof(header));
+        entrySize = sizeof(header) + header.binarySize;
+
+        // Write to a temporary file first so that a concurrent reader never sees a partial entry.
+        char path[sizeof(mDirectory) + 32];
+        char tmpPath[sizeof(path) + 4];
+        entryPath(key, path, sizeof(path));
+        snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+        FILE* file = fopen(tmpPath, "wb");
+        if (!file) {
+            fprintf(stderr, "Couldn't write program cache entry %s.\n", tmpPath);
+            free(entry);
+            return;
+        }
+        bool written = fwrite(entry, 1, entrySize, file) == entrySize;
+        written = (fclose(file) == 0) && written;
+        if (!written || rename(tmpPath, path) != 0) {
+            fprintf(stderr, "Couldn't write program cache entry %s.\n", path);
+            remove(tmpPath);
+        }
+        free(entry);
+    }
+
+    bool createProgram(GLuint& program, const ProgramDesc& desc, const ProgramCache* cache) {
+        TRACE_FUNCTION();
+        if (desc.numSources == 0 || desc.numSources > kMaxShaderStages) {
+            fprintf(stderr, "Programs require between 1 and %zu shaders.\n", kMaxShaderStages);
+            return false;
+        }
+
+        bool useCache = cache && cache->isEnabled();
+        uint64_t key = 0;
+        if (useCache) {
+            key = cache->computeKey(desc);
+            if (cache->load(key, program)) {
+                return true;
+            }
+        }
+
+        GLuint shaderObjects[kMaxShaderStages] = {0};
+        for (size_t idx = 0; idx < desc.numSources; idx++) {
+            if (!utils::createShaderFromString(
+                    shaderObjects[idx], desc.sources[idx].type, desc.sources[idx].source)) {
+                for (size_t created = 0; created <= idx; created++) {
+                    glDeleteShader(shaderObjects[created]);
+                }
+                return false;
+            }
+        }
+
+        program = glCreateProgram();
+        for (size_t idx = 0; idx < desc.numSources; idx++) {
+            glAttachShader(program, shaderObjects[idx]);
+        }
+        if (desc.numFeedbackVaryings > 0) {
+            glTransformFeedbackVaryings(
+                program,
+                static_cast<GLsizei>(desc.numFeedbackVaryings),
+                desc.feedbackVaryings,
+                desc.feedbackBufferMode);
+        }
+        if (useCache) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        bool linked = utils::linkProgram(program);
+        for (size_t idx = 0; idx < desc.numSources; idx++) {
+            if (linked) {
+                glDetachShader(program, shaderObjects[idx]);
+            }
+            glDeleteShader(shaderObjects[idx]);
+        }
+        if (!linked) {
+            return false;
+        }
+
+        if (useCache) {
+            cache->store(key, program);
+        }
+        return true;
+    }
+}  // namespace shaders
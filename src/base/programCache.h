@@ -0,0 +1,98 @@
+#ifndef RENDEER_PROGRAM_CACHE_HEADER
+#define RENDEER_PROGRAM_CACHE_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace shaders {
+    // Directory of the program cache when none is given, relative to the working directory.
+    static const char* const kDefaultCacheDirectory = ".shader-cache";
+
+    // Maximum number of shader stages composing a program.
+    static const size_t kMaxShaderStages = 6;
+
+    // Source code of a single shader stage.
+    struct ShaderSource {
+        GLenum type;
+        const char* source;
+    };
+
+    // Everything needed to build a program object from source.
+    struct ProgramDesc {
+        const ShaderSource* sources;
+        size_t numSources;
+        // Optional transform feedback varyings, declared before linking.
+        const char* const* feedbackVaryings;
+        size_t numFeedbackVaryings;
+        GLenum feedbackBufferMode;
+    };
+
+    /**
+     * @brief On-disk cache of linked program binaries. Each entry is keyed by a hash of the shader
+     *        sources, the transform feedback varyings, and the vendor, renderer and version strings
+     *        of the driver, so that a driver update invalidates the whole cache.
+     */
+    class ProgramCache {
+    public:
+        /**
+         * @brief Enables the cache, creating its directory if needed. The cache stays disabled if
+         *        the driver supports no program binary format.
+         *
+         * @param directory Directory holding the cached binaries.
+         * @return True if the cache is enabled.
+         */
+        bool init(const char* directory);
+
+        /** @brief Whether binaries are looked up and stored. */
+        bool isEnabled() const {
+            return mEnabled;
+        }
+
+        /** @brief Computes the key of a program for the current driver. */
+        uint64_t computeKey(const ProgramDesc& desc) const;
+
+        /**
+         * @brief Creates a program from a cached binary.
+         *
+         * @param key Key of the program, obtained via `computeKey`.
+         * @param program Program object created on success.
+         * @return True if a binary was found and accepted by the driver.
+         */
+        bool load(uint64_t key, GLuint& program) const;
+
+        /**
+         * @brief Stores the binary of a linked program. The program must have been linked with
+         *        `GL_PROGRAM_BINARY_RETRIEVABLE_HINT` set.
+         *
+         * @param key Key of the program, obtained via `computeKey`.
+         * @param program Linked program object.
+         */
+        void store(uint64_t key, GLuint program) const;
+
+    private:
+        /** @brief Writes the path of the cache entry of a key into `path`. */
+        void entryPath(uint64_t key, char* path, size_t pathSize) const;
+
+        bool mEnabled = false;
+        char mDirectory[256] = {};
+        // Hash of the driver identification strings, the starting point of every key.
+        uint64_t mDriverHash = 0;
+    };
+
+    /**
+     * @brief Creates a program object, restoring it from the cache if possible. Otherwise the
+     *        program is compiled and linked from source, and stored into the cache.
+     *
+     * @param program Reference to program object that will be created.
+     * @param desc Description of the program.
+     * @param cache Program cache, may be null to always compile from source.
+     * @return True if the creation of the program was successful, false otherwise.
+     */
+    bool createProgram(GLuint& program, const ProgramDesc& desc, const ProgramCache* cache);
+}  // namespace shaders
+
+#endif  // RENDEER_PROGRAM_CACHE_HEADER
@@ -0,0 +1,371 @@
+#include "rotation.h"
+
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RENDEER_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define RENDEER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rotation {
+    void computeCoefficients(float t, float* coeffs) {
+        float c1 = cosf(t);
+        float c2 = cosf(2.0F * t);
+        float c3 = cosf(3.0F * t);
+        float s1 = sinf(t);
+        float s2 = sinf(2.0F * t);
+        float s3 = sinf(3.0F * t);
+
+        // Row for x.
+        coeffs[0] = (1.0F + c2) / 2.0F;
+        coeffs[1] = (c1 - c3 - 2.0F * s2) / 4.0F;
+        coeffs[2] = (2.0F - 2.0F * c2 + s1 + s3) / 4.0F;
+        // Row for y.
+        coeffs[3] = s2 / 2.0F;
+        coeffs[4] = (2.0F + 2.0F * c2 + 3.0F * s1 - s3) / 4.0F;
+        coeffs[5] = (c1 - c3 - 2.0F * s2) / 4.0F;
+        // Row for z.
+        coeffs[6] = -s1;
+        coeffs[7] = s2 / 2.0F;
+        coeffs[8] = (1.0F + c2) / 2.0F;
+    }
+
+    linalg::Mat3 rotationMatrix(float t) {
+        float c[kNumCoefficients];
+        computeCoefficients(t, c);
+        return linalg::mat3FromRows(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8]);
+    }
+
+    linalg::Mat3 rotationMatrixSteps(float t, size_t numSteps) {
+        linalg::Mat3 step = rotationMatrix(t);
+        linalg::Mat3 mat = linalg::identity3();
+        for (size_t idx = 0; idx < numSteps; idx++) {
+            mat = step * mat;
+        }
+        return mat;
+    }
+
+    void coefficientsFromMatrix(const linalg::Mat3& mat, float* coeffs) {
+        for (size_t row = 0; row < 3; row++) {
+            for (size_t col = 0; col < 3; col++) {
+                coeffs[3 * row + col] = mat(row, col);
+            }
+        }
+    }
+
+    void rotateVerticesReference(float* vertices, size_t numVertices, float t) {
+        for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+            size_t idx = kFloatsPerVertex * vertexIdx;
+            float x = vertices[idx];
+            float y = vertices[idx + 1];
+            float z = vertices[idx + 2];
+
+            vertices[idx] = (2.0F * x + 2.0F * z + y * cosf(t) + 2.0F * x * cosf(2.0F * t) -
+                             2.0F * z * cosf(2.0F * t) - y * cosf(3.0F * t) + z * sinf(t) -
+                             2.0F * y * sinf(2.0F * t) + z * sinf(3.0F * t)) /
+                            4.0F;
+            vertices[idx + 1] = (2.0F * y + z * cosf(t) + 2.0F * y * cosf(2.0F * t) -
+                                 z * cosf(3.0F * t) + 3.0F * y * sinf(t) +
+                                 2.0F * x * sinf(2.0F * t) - 2.0F * z * sinf(2.0F * t) -
+                                 y * sinf(3.0F * t)) /
+                                4.0F;
+            vertices[idx + 2] =
+                (z + z * cosf(2.0F * t) - 2.0F * x * sinf(t) + y * sinf(2.0F * t)) / 2.0F;
+        }
+    }
+
+    /** @brief Plain scalar kernel, also used for the tail of the SSE kernel. */
+    static void rotateScalar(
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror) {
+        for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+            float* v = vertices + kFloatsPerVertex * vertexIdx;
+            float x = v[0];
+            float y = v[1];
+            float z = v[2];
+            v[0] = coeffs[0] * x + coeffs[1] * y + coeffs[2] * z;
+            v[1] = coeffs[3] * x + coeffs[4] * y + coeffs[5] * z;
+            v[2] = coeffs[6] * x + coeffs[7] * y + coeffs[8] * z;
+            if (mirror) {
+                float* m = mirror + kFloatsPerVertex * vertexIdx;
+                m[0] = v[0];
+                m[1] = v[1];
+                m[2] = v[2];
+                m[3] = v[3];
+            }
+        }
+    }
+
+#if defined(RENDEER_X86) || defined(RENDEER_NEON)
+    /**
+     * @brief Scalar tail of the FMA kernels, rounding each vertex exactly as their vector loop
+     *        does, so that the result doesn't depend on where the ranges of the jobs start.
+     */
+    static void rotateScalarFused(
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror) {
+        for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+            float* v = vertices + kFloatsPerVertex * vertexIdx;
+            float x = v[0];
+            float y = v[1];
+            float z = v[2];
+            v[0] = fmaf(coeffs[2], z, fmaf(coeffs[1], y, coeffs[0] * x));
+            v[1] = fmaf(coeffs[5], z, fmaf(coeffs[4], y, coeffs[3] * x));
+            v[2] = fmaf(coeffs[8], z, fmaf(coeffs[7], y, coeffs[6] * x));
+            if (mirror) {
+                float* m = mirror + kFloatsPerVertex * vertexIdx;
+                m[0] = v[0];
+                m[1] = v[1];
+                m[2] = v[2];
+                m[3] = v[3];
+            }
+        }
+    }
+#endif
+
+#if defined(RENDEER_X86)
+    /**
+     * @brief SSE kernel: four vertices are loaded, transposed into x, y, z and w registers,
+     *        transformed and transposed back.
+     */
+    static void rotateSSE(
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror) {
+        __m128 c[kNumCoefficients];
+        for (size_t idx = 0; idx < kNumCoefficients; idx++) {
+            c[idx] = _mm_set1_ps(coeffs[idx]);
+        }
+
+        size_t numBatched = numVertices & ~static_cast<size_t>(3);
+        for (size_t vertexIdx = 0; vertexIdx < numBatched; vertexIdx += 4) {
+            float* v = vertices + kFloatsPerVertex * vertexIdx;
+            __m128 x = _mm_loadu_ps(v);
+            __m128 y = _mm_loadu_ps(v + 4);
+            __m128 z = _mm_loadu_ps(v + 8);
+            __m128 w = _mm_loadu_ps(v + 12);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+
+            __m128 nx = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(c[0], x), _mm_mul_ps(c[1], y)), _mm_mul_ps(c[2], z));
+            __m128 ny = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(c[3], x), _mm_mul_ps(c[4], y)), _mm_mul_ps(c[5], z));
+            __m128 nz = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(c[6], x), _mm_mul_ps(c[7], y)), _mm_mul_ps(c[8], z));
+
+            _MM_TRANSPOSE4_PS(nx, ny, nz, w);
+            _mm_storeu_ps(v, nx);
+            _mm_storeu_ps(v + 4, ny);
+            _mm_storeu_ps(v + 8, nz);
+            _mm_storeu_ps(v + 12, w);
+            if (mirror) {
+                float* m = mirror + kFloatsPerVertex * vertexIdx;
+                _mm_storeu_ps(m, nx);
+                _mm_storeu_ps(m + 4, ny);
+                _mm_storeu_ps(m + 8, nz);
+                _mm_storeu_ps(m + 12, w);
+            }
+        }
+        rotateScalar(
+            vertices + kFloatsPerVertex * numBatched,
+            numVertices - numBatched,
+            coeffs,
+            mirror ? mirror + kFloatsPerVertex * numBatched : nullptr);
+    }
+
+    /**
+     * @brief In-lane 4x4 transpose of four AVX registers. Each 128-bit lane is transposed
+     *        independently, which is enough since every vertex is transformed the same way.
+     */
+    __attribute__((target("avx2,fma"))) static inline void transposeLanes(
+        __m256& r0,
+        __m256& r1,
+        __m256& r2,
+        __m256& r3) {
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+        __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    /** @brief AVX2 + FMA kernel transforming eight vertices per instruction. */
+    __attribute__((target("avx2,fma"))) static void rotateAVX2(
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror) {
+        __m256 c[kNumCoefficients];
+        for (size_t idx = 0; idx < kNumCoefficients; idx++) {
+            c[idx] = _mm256_set1_ps(coeffs[idx]);
+        }
+
+        size_t numBatched = numVertices & ~static_cast<size_t>(7);
+        for (size_t vertexIdx = 0; vertexIdx < numBatched; vertexIdx += 8) {
+            float* v = vertices + kFloatsPerVertex * vertexIdx;
+            __m256 x = _mm256_loadu_ps(v);
+            __m256 y = _mm256_loadu_ps(v + 8);
+            __m256 z = _mm256_loadu_ps(v + 16);
+            __m256 w = _mm256_loadu_ps(v + 24);
+            transposeLanes(x, y, z, w);
+
+            __m256 nx = _mm256_fmadd_ps(
+                c[2], z, _mm256_fmadd_ps(c[1], y, _mm256_mul_ps(c[0], x)));
+            __m256 ny = _mm256_fmadd_ps(
+                c[5], z, _mm256_fmadd_ps(c[4], y, _mm256_mul_ps(c[3], x)));
+            __m256 nz = _mm256_fmadd_ps(
+                c[8], z, _mm256_fmadd_ps(c[7], y, _mm256_mul_ps(c[6], x)));
+
+            transposeLanes(nx, ny, nz, w);
+            _mm256_storeu_ps(v, nx);
+            _mm256_storeu_ps(v + 8, ny);
+            _mm256_storeu_ps(v + 16, nz);
+            _mm256_storeu_ps(v + 24, w);
+            if (mirror) {
+                float* m = mirror + kFloatsPerVertex * vertexIdx;
+                _mm256_storeu_ps(m, nx);
+                _mm256_storeu_ps(m + 8, ny);
+                _mm256_storeu_ps(m + 16, nz);
+                _mm256_storeu_ps(m + 24, w);
+            }
+        }
+        rotateScalarFused(
+            vertices + kFloatsPerVertex * numBatched,
+            numVertices - numBatched,
+            coeffs,
+            mirror ? mirror + kFloatsPerVertex * numBatched : nullptr);
+    }
+#endif
+
+#if defined(RENDEER_NEON)
+    /** @brief NEON kernel, the structured loads deinterleave four vertices at once. */
+    static void rotateNEON(
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror) {
+        size_t numBatched = numVertices & ~static_cast<size_t>(3);
+        for (size_t vertexIdx = 0; vertexIdx < numBatched; vertexIdx += 4) {
+            float* v = vertices + kFloatsPerVertex * vertexIdx;
+            float32x4x4_t xyzw = vld4q_f32(v);
+            float32x4_t x = xyzw.val[0];
+            float32x4_t y = xyzw.val[1];
+            float32x4_t z = xyzw.val[2];
+
+            xyzw.val[0] =
+                vfmaq_n_f32(vfmaq_n_f32(vmulq_n_f32(x, coeffs[0]), y, coeffs[1]), z, coeffs[2]);
+            xyzw.val[1] =
+                vfmaq_n_f32(vfmaq_n_f32(vmulq_n_f32(x, coeffs[3]), y, coeffs[4]), z, coeffs[5]);
+            xyzw.val[2] =
+                vfmaq_n_f32(vfmaq_n_f32(vmulq_n_f32(x, coeffs[6]), y, coeffs[7]), z, coeffs[8]);
+            vst4q_f32(v, xyzw);
+            if (mirror) {
+                vst4q_f32(mirror + kFloatsPerVertex * vertexIdx, xyzw);
+            }
+        }
+        rotateScalarFused(
+            vertices + kFloatsPerVertex * numBatched,
+            numVertices - numBatched,
+            coeffs,
+            mirror ? mirror + kFloatsPerVertex * numBatched : nullptr);
+    }
+#endif
+
+    bool isKernelSupported(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::SCALAR: {
+                return true;
+            }
+#if defined(RENDEER_X86)
+            case Kernel::SSE: {
+                return __builtin_cpu_supports("sse2");
+            }
+            case Kernel::AVX2: {
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            }
+#endif
+#if defined(RENDEER_NEON)
+            case Kernel::NEON: {
+                return true;
+            }
+#endif
+            default: {
+                return false;
+            }
+        }
+    }
+
+    Kernel bestKernel() {
+        static const Kernel kBest = []() {
+            const Kernel candidates[] = {Kernel::AVX2, Kernel::NEON, Kernel::SSE};
+            for (Kernel kernel : candidates) {
+                if (isKernelSupported(kernel)) {
+                    return kernel;
+                }
+            }
+            return Kernel::SCALAR;
+        }();
+        return kBest;
+    }
+
+    const char* kernelName(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::SCALAR: {
+                return "scalar";
+            }
+            case Kernel::SSE: {
+                return "sse";
+            }
+            case Kernel::AVX2: {
+                return "avx2";
+            }
+            case Kernel::NEON: {
+                return "neon";
+            }
+        }
+        return "unknown";
+    }
+
+    void rotateVerticesWith(
+        Kernel kernel,
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror) {
+        switch (kernel) {
+#if defined(RENDEER_X86)
+            case Kernel::SSE: {
+                rotateSSE(vertices, numVertices, coeffs, mirror);
+            } break;
+            case Kernel::AVX2: {
+                rotateAVX2(vertices, numVertices, coeffs, mirror);
+            } break;
+#endif
+#if defined(RENDEER_NEON)
+            case Kernel::NEON: {
+                rotateNEON(vertices, numVertices, coeffs, mirror);
+            } break;
+#endif
+            default: {
+                rotateScalar(vertices, numVertices, coeffs, mirror);
+            }
+        }
+    }
+
+    void rotateVertices(float* vertices, size_t numVertices, float t, float* mirror) {
+        float coeffs[kNumCoefficients];
+        computeCoefficients(t, coeffs);
+        rotateVerticesWith(bestKernel(), vertices, numVertices, coeffs, mirror);
+    }
+}  // namespace rotation
@@ -0,0 +1,107 @@
+#ifndef RENDEER_ROTATION_HEADER
+#define RENDEER_ROTATION_HEADER
+
+#include <stddef.h>
+
+#include "linalg.h"
+
+namespace rotation {
+    // Number of floats composing a single vertex handled by the kernels (x, y, z, w). Only the
+    // first three components are transformed, `w` is left untouched.
+    static const size_t kFloatsPerVertex = 4;
+
+    // Number of coefficients of the 3x3 linear map applied to each vertex.
+    static const size_t kNumCoefficients = 9;
+
+    // Vectorized implementations of the rotation kernel.
+    enum class Kernel {
+        SCALAR,
+        SSE,
+        AVX2,
+        NEON,
+    };
+
+    /**
+     * @brief Computes the 3x3 linear map, in row-major order, that the triforce rotation by an
+     *        angle `t` applies to each vertex. The trigonometric functions are evaluated only once
+     *        per call, instead of once per vertex.
+     *
+     * @param t Common rotation angle for each axis.
+     * @param coeffs Output array of `kNumCoefficients` values.
+     */
+    void computeCoefficients(float t, float* coeffs);
+
+    /**
+     * @brief Same linear map as `computeCoefficients`, as a matrix that can be directly uploaded
+     *        to a `mat3` uniform.
+     *
+     * @param t Common rotation angle for each axis.
+     */
+    linalg::Mat3 rotationMatrix(float t);
+
+    /**
+     * @brief Linear map of `numSteps` successive rotations by an angle `t`, as a matrix. The
+     *        rotations about the three axes don't commute, so this differs from the rotation by
+     *        `numSteps * t`.
+     *
+     * @param t Common rotation angle for each axis of a single step.
+     * @param numSteps Number of steps, the identity for zero steps.
+     */
+    linalg::Mat3 rotationMatrixSteps(float t, size_t numSteps);
+
+    /**
+     * @brief Writes the coefficients of a linear map in the layout of `computeCoefficients`, to be
+     *        passed to the kernels.
+     */
+    void coefficientsFromMatrix(const linalg::Mat3& mat, float* coeffs);
+
+    /**
+     * @brief Original per-vertex trigonometric implementation of the rotation, kept as a reference
+     *        for benchmarking and validating the other kernels.
+     *
+     * @param vertices Array of `numVertices * kFloatsPerVertex` floats rotated in place.
+     * @param numVertices Number of vertices in `vertices`.
+     * @param t Common rotation angle for each axis.
+     */
+    void rotateVerticesReference(float* vertices, size_t numVertices, float t);
+
+    /**
+     * @brief Rotates the vertices in place with a given kernel, which must be supported by the
+     *        running CPU (see `isKernelSupported`).
+     *
+     * @param kernel Kernel implementation to be used.
+     * @param vertices Array of `numVertices * kFloatsPerVertex` floats rotated in place.
+     * @param numVertices Number of vertices in `vertices`.
+     * @param coeffs Coefficients obtained via `computeCoefficients`.
+     * @param mirror Optional array of the same size as `vertices` that also receives the rotated
+     *        vertices, such as a buffer mapped from the GPU. It is only written to, never read.
+     */
+    void rotateVerticesWith(
+        Kernel kernel,
+        float* vertices,
+        size_t numVertices,
+        const float* coeffs,
+        float* mirror = nullptr);
+
+    /**
+     * @brief Rotates the vertices in place using the fastest kernel supported by the running CPU.
+     *
+     * @param vertices Array of `numVertices * kFloatsPerVertex` floats rotated in place.
+     * @param numVertices Number of vertices in `vertices`.
+     * @param t Common rotation angle for each axis.
+     * @param mirror Optional array of the same size as `vertices` that also receives the rotated
+     *        vertices. It is only written to, never read.
+     */
+    void rotateVertices(float* vertices, size_t numVertices, float t, float* mirror = nullptr);
+
+    /** @brief Whether the kernel was compiled in and can run on the current CPU. */
+    bool isKernelSupported(Kernel kernel);
+
+    /** @brief Fastest kernel supported by the running CPU, detected once at runtime. */
+    Kernel bestKernel();
+
+    /** @brief Human readable name of the kernel. */
+    const char* kernelName(Kernel kernel);
+}  // namespace rotation
+
+#endif  // RENDEER_ROTATION_HEADER
@@ -0,0 +1,157 @@
+#include "shaderBatch.h"
+
+#include <stdio.h>
+
+#include "trace.h"
+#include "utils.h"
+
+namespace shaders {
+    // Requests as many compiler threads as the implementation is willing to use.
+    static const GLuint kMaxCompilerThreads = 0xFFFFFFFF;
+
+    bool hasParallelCompile() {
+        return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+    }
+
+    /** @brief Lets the driver spawn its compiler threads, only done once per process. */
+    static void enableCompilerThreads() {
+        static bool sEnabled = false;
+        if (sEnabled) {
+            return;
+        }
+        if (GLAD_GL_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(kMaxCompilerThreads);
+        } else if (GLAD_GL_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(kMaxCompilerThreads);
+        }
+        sEnabled = true;
+    }
+
+    bool ProgramBatch::add(GLuint& program, const ProgramDesc& desc) {
+        if (mSubmitted) {
+            fprintf(stderr, "Programs cannot be added to a submitted batch.\n");
+            return false;
+        }
+        if (mNumEntries == kMaxBatchPrograms) {
+            fprintf(stderr, "Program batches hold at most %zu programs.\n", kMaxBatchPrograms);
+            return false;
+        }
+        if (desc.numSources == 0 || desc.numSources > kMaxShaderStages) {
+            fprintf(stderr, "Programs require between 1 and %zu shaders.\n", kMaxShaderStages);
+            return false;
+        }
+
+        Entry& entry = mEntries[mNumEntries++];
+        entry.desc = desc;
+        entry.program = &program;
+        entry.key = 0;
+        entry.fromCache = false;
+        program = 0;
+        return true;
+    }
+
+    void ProgramBatch::submit(const ProgramCache* cache) {
+        TRACE_SCOPE("ProgramBatch::submit");
+        mCache = (cache && cache->isEnabled()) ? cache : nullptr;
+        mSubmitted = true;
+        if (hasParallelCompile()) {
+            enableCompilerThreads();
+        }
+
+        // Restore the cached programs first, so that the driver threads only see the others.
+        for (size_t idx = 0; idx < mNumEntries; idx++) {
+            Entry& entry = mEntries[idx];
+            if (mCache) {
+                entry.key = mCache->computeKey(entry.desc);
+                entry.fromCache = mCache->load(entry.key, *entry.program);
+            }
+        }
+
+        // Every compile is issued before any link, as a link waits for its shaders.
+        for (size_t idx = 0; idx < mNumEntries; idx++) {
+            Entry& entry = mEntries[idx];
+            if (entry.fromCache) {
+                continue;
+            }
+            for (size_t stage = 0; stage < entry.desc.numSources; stage++) {
+                const ShaderSource& source = entry.desc.sources[stage];
+                entry.shaders[stage] = glCreateShader(source.type);
+                glShaderSource(entry.shaders[stage], 1, &source.source, nullptr);
+                glCompileShader(entry.shaders[stage]);
+            }
+        }
+
+        for (size_t idx = 0; idx < mNumEntries; idx++) {
+            Entry& entry = mEntries[idx];
+            if (entry.fromCache) {
+                continue;
+            }
+            GLuint program = glCreateProgram();
+            for (size_t stage = 0; stage < entry.desc.numSources; stage++) {
+                glAttachShader(program, entry.shaders[stage]);
+            }
+            if (entry.desc.numFeedbackVaryings > 0) {
+                glTransformFeedbackVaryings(
+                    program,
+                    static_cast<GLsizei>(entry.desc.numFeedbackVaryings),
+                    entry.desc.feedbackVaryings,
+                    entry.desc.feedbackBufferMode);
+            }
+            if (mCache) {
+                glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            }
+            glLinkProgram(program);
+            *entry.program = program;
+        }
+    }
+
+    bool ProgramBatch::finish() {
+        TRACE_SCOPE("ProgramBatch::finish");
+        if (!mSubmitted) {
+            fprintf(stderr, "Program batches must be submitted before being finished.\n");
+            return false;
+        }
+
+        bool success = true;
+        size_t numCached = 0;
+        for (size_t idx = 0; idx < mNumEntries; idx++) {
+            Entry& entry = mEntries[idx];
+            if (entry.fromCache) {
+                numCached++;
+                continue;
+            }
+
+            // The compile errors are more informative than the resulting link error.
+            bool built = true;
+            for (size_t stage = 0; stage < entry.desc.numSources; stage++) {
+                built = utils::checkCompileStatus(
+                            entry.shaders[stage], entry.desc.sources[stage].type) &&
+                        built;
+            }
+            built = built && utils::checkLinkStatus(*entry.program);
+
+            for (size_t stage = 0; stage < entry.desc.numSources; stage++) {
+                glDetachShader(*entry.program, entry.shaders[stage]);
+                glDeleteShader(entry.shaders[stage]);
+            }
+
+            if (!built) {
+                glDeleteProgram(*entry.program);
+                *entry.program = 0;
+                success = false;
+            } else if (mCache) {
+                mCache->store(entry.key, *entry.program);
+            }
+        }
+
+        printf(
+            "Built %zu programs (%zu from the cache), %s.\n",
+            mNumEntries,
+            numCached,
+            hasParallelCompile() ? "compiled in parallel" : "compiled serially");
+
+        mNumEntries = 0;
+        mSubmitted = false;
+        return success;
+    }
+}  // namespace shaders
@@ -0,0 +1,76 @@
+#ifndef RENDEER_SHADER_BATCH_HEADER
+#define RENDEER_SHADER_BATCH_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "programCache.h"
+
+namespace shaders {
+    // Maximum number of programs built by a single batch.
+    static const size_t kMaxBatchPrograms = 16;
+
+    /**
+     * @brief Whether the driver compiles and links in the background, exposing the progress through
+     *        `GL_COMPLETION_STATUS_KHR`.
+     */
+    bool hasParallelCompile();
+
+    /**
+     * @brief Builds several programs at once. Every compile and link is submitted up front, and no
+     *        status is queried until the programs are needed, so that the driver can compile them
+     *        concurrently while the application carries on with other work, such as creating its
+     *        buffers.
+     *
+     * Usage: `add` every program, `submit` the batch, do some unrelated work, and `finish` it.
+     */
+    class ProgramBatch {
+    public:
+        /**
+         * @brief Queues a program to be built by the batch.
+         *
+         * @param program Program object, valid once `finish` succeeds. It must outlive the batch.
+         * @param desc Description of the program. It is copied, but the sources and varyings it
+         *        points to must outlive the batch.
+         * @return False if the batch is full or was already submitted.
+         */
+        bool add(GLuint& program, const ProgramDesc& desc);
+
+        /**
+         * @brief Submits the compilation and link of every queued program without waiting for
+         *        them. Programs found in the cache are restored right away instead.
+         *
+         * @param cache Program cache, may be null to always compile from source.
+         */
+        void submit(const ProgramCache* cache);
+
+        /**
+         * @brief Waits for the batch to be built, reports the errors of every failed compile or
+         *        link, and stores the new binaries into the cache. Programs that failed are deleted
+         *        and set to zero.
+         *
+         * @return True if every program was built successfully.
+         */
+        bool finish();
+
+    private:
+        struct Entry {
+            ProgramDesc desc;
+            GLuint* program;
+            GLuint shaders[kMaxShaderStages];
+            uint64_t key;
+            bool fromCache;
+        };
+
+        Entry mEntries[kMaxBatchPrograms] = {};
+        size_t mNumEntries = 0;
+        const ProgramCache* mCache = nullptr;
+        bool mSubmitted = false;
+    };
+}  // namespace shaders
+
+#endif  // RENDEER_SHADER_BATCH_HEADER
@@ -0,0 +1,81 @@
+#include "streamBuffer.h"
+
+#include <stdio.h>
+
+namespace stream {
+    // Time, in nanoseconds, waited on a fence before reporting the GPU as slow.
+    static const GLuint64 kFenceTimeout = 1000000000;
+
+    bool StreamBuffer::init(GLenum target, size_t regionSize, size_t numRegions) {
+        if (numRegions == 0 || numRegions > kMaxRegions) {
+            fprintf(stderr, "Stream buffers support between 1 and %zu regions.\n", kMaxRegions);
+            return false;
+        }
+
+        mRegionSize = (regionSize + kRegionAlignment - 1) & ~(kRegionAlignment - 1);
+        mNumRegions = numRegions;
+        mCurrentRegion = numRegions - 1;
+        GLsizeiptr size = static_cast<GLsizeiptr>(mRegionSize * mNumRegions);
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glGenBuffers(1, &mBuffer);
+        glBindBuffer(target, mBuffer);
+        glBufferStorage(target, size, nullptr, flags);
+        mMapped = static_cast<uint8_t*>(glMapBufferRange(target, 0, size, flags));
+        glBindBuffer(target, 0);
+
+        if (!mMapped) {
+            fprintf(
+                stderr,
+                "Unable to persistently map a stream buffer of %zu bytes.\n",
+                mRegionSize * mNumRegions);
+            destroy();
+            return false;
+        }
+        return true;
+    }
+
+    void StreamBuffer::destroy() {
+        for (size_t idx = 0; idx < kMaxRegions; idx++) {
+            if (mFences[idx]) {
+                glDeleteSync(mFences[idx]);
+                mFences[idx] = nullptr;
+            }
+        }
+        if (mBuffer != 0) {
+            // Deleting a buffer implicitly unmaps it.
+            glDeleteBuffers(1, &mBuffer);
+            mBuffer = 0;
+        }
+        mMapped = nullptr;
+    }
+
+    void* StreamBuffer::beginRegion() {
+        mCurrentRegion = (mCurrentRegion + 1) % mNumRegions;
+
+        GLsync fence = mFences[mCurrentRegion];
+        if (fence) {
+            GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            while (true) {
+                GLenum result = glClientWaitSync(fence, waitFlags, kFenceTimeout);
+                if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+                    break;
+                }
+                if (result == GL_WAIT_FAILED) {
+                    fprintf(stderr, "Failed to wait for a stream buffer region.\n");
+                    break;
+                }
+                fprintf(stderr, "Still waiting for the GPU to release a stream buffer region...\n");
+                waitFlags = 0;
+            }
+            glDeleteSync(fence);
+            mFences[mCurrentRegion] = nullptr;
+        }
+
+        return mMapped + mCurrentRegion * mRegionSize;
+    }
+
+    void StreamBuffer::endRegion() {
+        mFences[mCurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}  // namespace stream
@@ -0,0 +1,106 @@
+#ifndef RENDEER_STREAM_BUFFER_HEADER
+#define RENDEER_STREAM_BUFFER_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace stream {
+    // Maximum number of regions a stream buffer can be divided into.
+    static const size_t kMaxRegions = 4;
+
+    // Default number of regions: one written by the CPU, up to two in flight on the GPU.
+    static const size_t kDefaultRegions = 3;
+
+    /**
+     * @brief Buffer object persistently mapped into the address space of the application,
+     *        divided into a ring of equally sized regions. Each frame the CPU writes directly into
+     *        one region while the GPU reads from the previous ones. A fence placed after the last
+     *        command reading a region guards it from being overwritten while the GPU still uses
+     *        it, so there is neither a driver copy nor an implicit synchronization, as with
+     *        `glBufferSubData`.
+     *
+     * The OpenGL objects are not released on destruction, since the context may already be gone,
+     * `destroy` must be called explicitly.
+     */
+    class StreamBuffer {
+    public:
+        // Alignment of the regions, large enough for any buffer binding target.
+        static const size_t kRegionAlignment = 256;
+
+        StreamBuffer() = default;
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        /**
+         * @brief Creates the buffer storage and maps it. Requires OpenGL 4.4.
+         *
+         * @param target Buffer binding target used to create the buffer, such as `GL_ARRAY_BUFFER`.
+         * @param regionSize Size in bytes of each region. It is rounded up to `kRegionAlignment`.
+         * @param numRegions Number of regions composing the ring, at most `kMaxRegions`.
+         * @return True if the buffer was successfully created and mapped.
+         */
+        bool init(GLenum target, size_t regionSize, size_t numRegions = kDefaultRegions);
+
+        /** @brief Unmaps and deletes the buffer, and deletes any pending fences. */
+        void destroy();
+
+        /**
+         * @brief Moves to the next region of the ring, waiting for the GPU to be done with it if
+         *        necessary.
+         *
+         * @return Pointer to the mapped memory of the region, which can only be written to.
+         */
+        void* beginRegion();
+
+        /**
+         * @brief Fences the current region. Must be called after the last command reading from the
+         *        region has been issued.
+         */
+        void endRegion();
+
+        /** @brief Name of the buffer object. */
+        GLuint buffer() const {
+            return mBuffer;
+        }
+
+        /** @brief Size in bytes of each region. */
+        size_t regionSize() const {
+            return mRegionSize;
+        }
+
+        /** @brief Number of regions composing the ring. */
+        size_t numRegions() const {
+            return mNumRegions;
+        }
+
+        /** @brief Index of the current region. */
+        size_t currentRegion() const {
+            return mCurrentRegion;
+        }
+
+        /** @brief Offset in bytes of the current region from the start of the buffer. */
+        GLintptr regionOffset() const {
+            return regionOffset(mCurrentRegion);
+        }
+
+        /** @brief Offset in bytes of the given region from the start of the buffer. */
+        GLintptr regionOffset(size_t region) const {
+            return static_cast<GLintptr>(region * mRegionSize);
+        }
+
+    private:
+        GLuint mBuffer = 0;
+        uint8_t* mMapped = nullptr;
+        size_t mRegionSize = 0;
+        size_t mNumRegions = 0;
+        size_t mCurrentRegion = 0;
+        GLsync mFences[kMaxRegions] = {};
+    };
+}  // namespace stream
+
+#endif  // RENDEER_STREAM_BUFFER_HEADER
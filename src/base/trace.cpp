@@ -0,0 +1,200 @@
+#include "trace.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+
+namespace tracing {
+    // Complete event, with a duration, as recorded by a thread.
+    struct Event {
+        const char* name;
+        uint64_t beginNs;
+        uint64_t endNs;
+    };
+
+    // Events of a single thread. Only the thread owning the buffer writes to it, and publishes
+    // each event by incrementing `count`.
+    struct ThreadBuffer {
+        Event* events;
+        size_t capacity;
+        std::atomic<size_t> count;
+        size_t numDropped;
+        uint32_t tid;
+        char name[32];
+        ThreadBuffer* next;
+    };
+
+    // Whether the events are recorded, and number of events of the buffers allocated from then on.
+    static std::atomic<bool> sEnabled{false};
+    static std::atomic<size_t> sEventsPerThread{kDefaultEventsPerThread};
+
+    // Start of the trace, from which the timestamps of the events are written.
+    static uint64_t sStartNs = 0;
+
+    // List of every buffer, pushed to without a lock. The buffers live until the process exits,
+    // since the threads owning them may outlive the trace.
+    static std::atomic<ThreadBuffer*> sBuffers{nullptr};
+    static std::atomic<uint32_t> sNextTid{1};
+
+    // Buffer of the calling thread, and buffer of the GPU track.
+    static thread_local ThreadBuffer* tBuffer = nullptr;
+    static ThreadBuffer* sGpuBuffer = nullptr;
+
+    uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    /**
+     * @brief Allocates a buffer and pushes it to the list of buffers. Without a name, the buffer
+     *        is named after its thread identifier.
+     */
+    static ThreadBuffer* createBuffer(const char* name) {
+        ThreadBuffer* buffer = new ThreadBuffer;
+        buffer->capacity = sEventsPerThread.load(std::memory_order_relaxed);
+        buffer->events = new Event[buffer->capacity];
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->numDropped = 0;
+        buffer->tid = sNextTid.fetch_add(1, std::memory_order_relaxed);
+        if (name) {
+            snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+        } else {
+            snprintf(buffer->name, sizeof(buffer->name), "thread %u", buffer->tid);
+        }
+
+        buffer->next = sBuffers.load(std::memory_order_relaxed);
+        while (!sBuffers.compare_exchange_weak(
+            buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return buffer;
+    }
+
+    /** @brief Buffer of the calling thread, allocated on its first use. */
+    static ThreadBuffer* threadBuffer() {
+        if (!tBuffer) {
+            tBuffer = createBuffer(nullptr);
+        }
+        return tBuffer;
+    }
+
+    /** @brief Appends an event to a buffer, dropping it if the buffer is full. */
+    static void pushEvent(
+        ThreadBuffer* buffer,
+        const char* name,
+        uint64_t beginNs,
+        uint64_t endNs) {
+        size_t count = buffer->count.load(std::memory_order_relaxed);
+        if (count == buffer->capacity) {
+            buffer->numDropped++;
+            return;
+        }
+        buffer->events[count] = {name, beginNs, endNs};
+        buffer->count.store(count + 1, std::memory_order_release);
+    }
+
+    void start(size_t eventsPerThread) {
+        size_t capacity = eventsPerThread > 0 ? eventsPerThread : 1;
+        sEventsPerThread.store(capacity, std::memory_order_relaxed);
+        sStartNs = nowNs();
+        if (!sGpuBuffer) {
+            sGpuBuffer = createBuffer("GPU");
+        }
+        sEnabled.store(true, std::memory_order_release);
+    }
+
+    bool isEnabled() {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+
+    void setThreadName(const char* name) {
+        snprintf(threadBuffer()->name, sizeof(ThreadBuffer::name), "%s", name);
+    }
+
+    void recordEvent(const char* name, uint64_t beginNs, uint64_t endNs) {
+        if (isEnabled()) {
+            pushEvent(threadBuffer(), name, beginNs, endNs);
+        }
+    }
+
+    void recordGpuEvent(const char* name, uint64_t beginNs, uint64_t endNs) {
+        if (isEnabled()) {
+            pushEvent(sGpuBuffer, name, beginNs, endNs);
+        }
+    }
+
+    /** @brief Microseconds from the start of the trace, negative for earlier timestamps. */
+    static double traceUs(uint64_t ns) {
+        return (static_cast<double>(ns) - static_cast<double>(sStartNs)) * 1e-3;
+    }
+
+    /** @brief Writes a quoted JSON string, escaping quotes, backslashes and control characters. */
+    static void writeJsonString(FILE* file, const char* str) {
+        fputc('"', file);
+        for (const char* chr = str; *chr != '\0'; chr++) {
+            unsigned char value = static_cast<unsigned char>(*chr);
+            if (value == '"' || value == '\\') {
+                fputc('\\', file);
+                fputc(value, file);
+            } else if (value < 0x20) {
+                fprintf(file, "\\u%04x", value);
+            } else {
+                fputc(value, file);
+            }
+        }
+        fputc('"', file);
+    }
+
+    bool writeChromeTrace(const char* path) {
+        sEnabled.store(false, std::memory_order_relaxed);
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            fprintf(stderr, "Unable to open '%s' for writing.\n", path);
+            return false;
+        }
+
+        fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, ");
+        fprintf(file, "\"args\": {\"name\": \"rendeer\"}}");
+        size_t numEvents = 0;
+        size_t numDropped = 0;
+        for (ThreadBuffer* buffer = sBuffers.load(std::memory_order_acquire); buffer;
+             buffer = buffer->next) {
+            fprintf(
+                file,
+                ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, "
+                "\"args\": {\"name\": ",
+                buffer->tid);
+            writeJsonString(file, buffer->name);
+            fprintf(file, "}}");
+            size_t count = buffer->count.load(std::memory_order_acquire);
+            for (size_t idx = 0; idx < count; idx++) {
+                const Event& event = buffer->events[idx];
+                fprintf(file, ",\n{\"name\": ");
+                writeJsonString(file, event.name);
+                fprintf(
+                    file,
+                    ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                    buffer->tid,
+                    traceUs(event.beginNs),
+                    event.endNs > event.beginNs
+                        ? static_cast<double>(event.endNs - event.beginNs) * 1e-3
+                        : 0.0);
+            }
+            numEvents += count;
+            numDropped += buffer->numDropped;
+        }
+        fprintf(file, "\n]}\n");
+        if (fclose(file) != 0) {
+            fprintf(stderr, "Unable to write '%s'.\n", path);
+            return false;
+        }
+
+        printf("Wrote %zu trace events to '%s'", numEvents, path);
+        if (numDropped > 0) {
+            printf(", %zu more were dropped from full buffers", numDropped);
+        }
+        printf(".\n");
+        return true;
+    }
+}  // namespace tracing
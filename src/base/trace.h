@@ -0,0 +1,92 @@
+#ifndef RENDEER_TRACE_HEADER
+#define RENDEER_TRACE_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Timeline tracing of CPU scopes, and of the GPU scopes timed by `profiling::GpuProfiler`, written
+// as Chrome trace events, which `chrome://tracing` and the Perfetto UI open. Each thread records
+// into its own buffer, without any lock, and only while tracing is started.
+namespace tracing {
+    // Default number of events each thread can record, further events being dropped.
+    static const size_t kDefaultEventsPerThread = 1 << 16;
+
+    /** @brief Current time of `std::chrono::steady_clock`, in nanoseconds, the trace clock. */
+    uint64_t nowNs();
+
+    /**
+     * @brief Starts recording events, each thread allocating its buffer on its first event.
+     *
+     * @param eventsPerThread Number of events each thread can record.
+     */
+    void start(size_t eventsPerThread = kDefaultEventsPerThread);
+
+    /** @brief Whether events are being recorded. */
+    bool isEnabled();
+
+    /**
+     * @brief Names the calling thread in the trace.
+     *
+     * @param name Name of the thread, truncated to 31 characters.
+     */
+    void setThreadName(const char* name);
+
+    /**
+     * @brief Records a complete event on the calling thread.
+     *
+     * @param name Name of the event, which must outlive the trace, such as a literal.
+     * @param beginNs Start of the event on the trace clock.
+     * @param endNs End of the event on the trace clock.
+     */
+    void recordEvent(const char* name, uint64_t beginNs, uint64_t endNs);
+
+    /**
+     * @brief Records a complete event on the GPU track. Must be called from a single thread, the
+     *        one owning the OpenGL context.
+     *
+     * @param name Name of the event, which must outlive the trace, such as a literal.
+     * @param beginNs Start of the event, already converted to the trace clock.
+     * @param endNs End of the event, already converted to the trace clock.
+     */
+    void recordGpuEvent(const char* name, uint64_t beginNs, uint64_t endNs);
+
+    /**
+     * @brief Stops recording and writes every event recorded as Chrome trace event JSON. The
+     *        threads must not record events meanwhile.
+     *
+     * @param path Path of the file written.
+     * @return False if the file couldn't be written.
+     */
+    bool writeChromeTrace(const char* path);
+
+    /** @brief Records the lifetime of a block as an event, see `TRACE_SCOPE`. */
+    class Scope {
+    public:
+        explicit Scope(const char* name) : mName(name), mBeginNs(isEnabled() ? nowNs() : 0) {}
+        ~Scope() {
+            if (mBeginNs != 0) {
+                recordEvent(mName, mBeginNs, nowNs());
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* mName;
+        uint64_t mBeginNs;
+    };
+}  // namespace tracing
+
+// Traces the enclosing block as an event named `name`, or the enclosing function. Defining
+// `RENDEER_NO_TRACING` compiles the scopes out altogether.
+#if defined(RENDEER_NO_TRACING)
+#define TRACE_SCOPE(name)
+#else
+#define RENDEER_TRACE_CONCAT_IMPL(a, b) a##b
+#define RENDEER_TRACE_CONCAT(a, b) RENDEER_TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) tracing::Scope RENDEER_TRACE_CONCAT(traceScope, __LINE__)(name)
+#endif
+#define TRACE_FUNCTION() TRACE_SCOPE(__func__)
+
+#endif  // RENDEER_TRACE_HEADER
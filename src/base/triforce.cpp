@@ -0,0 +1,47 @@
+#include "triforce.h"
+
+#include <math.h>
+
+namespace triforce {
+    // Triforce vertex positions in the xy plane.
+    static const float kVertexPositions[kVerticesPerInstance * 2] = {
+        // clang-format off
+        // Upper triangle
+        0.0F, 0.5F,
+        -0.25F, 0.0F,
+        0.25F, 0.0F,
+        // Down left triangle
+        -0.25F, 0.0F,
+        -0.5F, -0.5F,
+        0.0F, -0.5F,
+        // Down right triangle
+        0.25F, 0.0F,
+        0.0F, -0.5F,
+        0.5F, -0.5F,
+        // clang-format on
+    };
+
+    void tile(float* dst, size_t numInstances, size_t floatsPerVertex) {
+        size_t gridSide = static_cast<size_t>(ceil(sqrt(static_cast<double>(numInstances))));
+        if (gridSide == 0) {
+            return;
+        }
+        float scale = 1.0F / static_cast<float>(gridSide);
+
+        for (size_t instanceIdx = 0; instanceIdx < numInstances; instanceIdx++) {
+            // Center of the grid cell, the grid spanning [-0.5, 0.5] in both axes.
+            float centerX = -0.5F + (static_cast<float>(instanceIdx % gridSide) + 0.5F) * scale;
+            float centerY = 0.5F - (static_cast<float>(instanceIdx / gridSide) + 0.5F) * scale;
+
+            for (size_t vertexIdx = 0; vertexIdx < kVerticesPerInstance; vertexIdx++) {
+                dst[0] = centerX + scale * kVertexPositions[2 * vertexIdx];
+                dst[1] = centerY + scale * kVertexPositions[2 * vertexIdx + 1];
+                dst[2] = 0.0F;
+                if (floatsPerVertex == 4) {
+                    dst[3] = 1.0F;
+                }
+                dst += floatsPerVertex;
+            }
+        }
+    }
+}  // namespace triforce
@@ -0,0 +1,25 @@
+#ifndef RENDEER_TRIFORCE_HEADER
+#define RENDEER_TRIFORCE_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace triforce {
+    // Number of vertices composing a single triforce: three triangles.
+    static const size_t kVerticesPerInstance = 9;
+
+    // Maximum number of triforces in a scene, so that its vertex count fits in a `GLsizei`.
+    static const size_t kMaxInstances = INT32_MAX / kVerticesPerInstance;
+
+    /**
+     * @brief Procedurally tiles copies of the triforce over a square grid covering the footprint
+     *        of a single triforce, so that the scene looks alike for any number of instances.
+     *
+     * @param dst Output array of `numInstances * kVerticesPerInstance * floatsPerVertex` floats.
+     * @param numInstances Number of triforces to generate.
+     * @param floatsPerVertex Either 3 (x, y, z) or 4 (x, y, z, w), with `w` set to one.
+     */
+    void tile(float* dst, size_t numInstances, size_t floatsPerVertex);
+}  // namespace triforce
+
+#endif  // RENDEER_TRIFORCE_HEADER
@@ -0,0 +1,62 @@
+#include "uniformRing.h"
+
+#include <stdio.h>
+
+namespace uniforms {
+    bool UniformRing::init(size_t frameSize, size_t numFrames) {
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        mAlignment = alignment > 0 ? static_cast<size_t>(alignment) : 1;
+        // The regions of the stream buffer start at multiples of its own alignment.
+        if (stream::StreamBuffer::kRegionAlignment % mAlignment != 0) {
+            fprintf(stderr, "Unsupported uniform buffer offset alignment of %zu.\n", mAlignment);
+            return false;
+        }
+
+        mUsed = 0;
+        mFrameData = nullptr;
+        return mStream.init(GL_UNIFORM_BUFFER, frameSize, numFrames);
+    }
+
+    void UniformRing::destroy() {
+        mStream.destroy();
+        mFrameData = nullptr;
+    }
+
+    void UniformRing::beginFrame() {
+        mFrameData = static_cast<uint8_t*>(mStream.beginRegion());
+        mUsed = 0;
+    }
+
+    bool UniformRing::allocate(size_t size, Allocation& allocation) {
+        size_t offset = (mUsed + mAlignment - 1) / mAlignment * mAlignment;
+        if (!mFrameData || offset + size > mStream.regionSize()) {
+            fprintf(
+                stderr,
+                "Uniform ring out of memory: %zu bytes requested, %zu of %zu bytes used.\n",
+                size,
+                mUsed,
+                mStream.regionSize());
+            return false;
+        }
+
+        allocation.data = mFrameData + offset;
+        allocation.offset = mStream.regionOffset() + static_cast<GLintptr>(offset);
+        allocation.size = static_cast<GLsizeiptr>(size);
+        mUsed = offset + size;
+        return true;
+    }
+
+    void UniformRing::bind(
+        glstate::StateCache& state,
+        GLuint binding,
+        const Allocation& allocation) {
+        state.bindBufferRange(
+            GL_UNIFORM_BUFFER, binding, mStream.buffer(), allocation.offset, allocation.size);
+    }
+
+    void UniformRing::endFrame() {
+        mStream.endRegion();
+        mFrameData = nullptr;
+    }
+}  // namespace uniforms
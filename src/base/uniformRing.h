@@ -0,0 +1,96 @@
+#ifndef RENDEER_UNIFORM_RING_HEADER
+#define RENDEER_UNIFORM_RING_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glState.h"
+#include "streamBuffer.h"
+
+namespace uniforms {
+    // Default size of the constants written in a single frame.
+    static const size_t kDefaultFrameSize = 64 * 1024;
+
+    // Block of constants allocated from a `UniformRing`, to be bound to a uniform block.
+    struct Allocation {
+        // Mapped memory of the block, which can only be written to.
+        void* data;
+        // Offset in bytes of the block from the start of the ring buffer.
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    /**
+     * @brief Per-frame linear allocator of uniform blocks, carved out of a persistently mapped
+     *        `stream::StreamBuffer` used as a ring of one region per frame in flight.
+     *
+     * Each frame, the per-frame and per-object constants are written straight into the mapped
+     * memory and bound with `glBindBufferRange`, so that a block shared by several programs, such
+     * as the camera, is uploaded once per frame whichever program reads it, and no constant goes
+     * through a `glUniform*` call.
+     *
+     * The OpenGL objects are not released on destruction, since the context may already be gone,
+     * `destroy` must be called explicitly.
+     */
+    class UniformRing {
+    public:
+        UniformRing() = default;
+
+        UniformRing(const UniformRing&) = delete;
+        UniformRing& operator=(const UniformRing&) = delete;
+
+        /**
+         * @brief Creates the ring buffer. Requires OpenGL 4.4.
+         *
+         * @param frameSize Size in bytes of the blocks allocated in a single frame.
+         * @param numFrames Number of frames in flight, at most `stream::kMaxRegions`.
+         * @return True if the buffer was successfully created and mapped.
+         */
+        bool init(
+            size_t frameSize = kDefaultFrameSize,
+            size_t numFrames = stream::kDefaultRegions);
+
+        /** @brief Unmaps and deletes the ring buffer. */
+        void destroy();
+
+        /** @brief Moves to the region of the next frame, waiting for the GPU to release it. */
+        void beginFrame();
+
+        /**
+         * @brief Allocates a block from the region of the current frame, aligned to
+         *        `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT`.
+         *
+         * @param size Size in bytes of the block, which must match the `std140` layout of the
+         *        uniform block it is bound to.
+         * @param allocation Receives the block.
+         * @return False if the region of the frame is full.
+         */
+        bool allocate(size_t size, Allocation& allocation);
+
+        /** @brief Binds a block to the binding point of a uniform block. */
+        void bind(glstate::StateCache& state, GLuint binding, const Allocation& allocation);
+
+        /**
+         * @brief Fences the region of the current frame. Must be called after the last command
+         *        reading its blocks has been issued.
+         */
+        void endFrame();
+
+        /** @brief Number of bytes allocated in the current frame, including alignment padding. */
+        size_t frameUsed() const {
+            return mUsed;
+        }
+
+    private:
+        stream::StreamBuffer mStream;
+        uint8_t* mFrameData = nullptr;
+        size_t mAlignment = 0;
+        size_t mUsed = 0;
+    };
+}  // namespace uniforms
+
+#endif  // RENDEER_UNIFORM_RING_HEADER
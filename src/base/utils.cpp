@@ -1,4 +1,6 @@
 #include "utils.h"
+#include "fileView.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,6 +11,7 @@
 
 namespace utils {
     const char* readFileToBuffer(const char* path) {
+        TRACE_FUNCTION();
         FILE* file = fopen(path, "rb");
         if (!file) {
             fprintf(stderr, "Couldn't open file %s.\n", path);
@@ -17,15 +20,18 @@ namespace utils {
 
         if (fseek(file, 0, SEEK_END) == -1) {
             fprintf(stderr, "Couldn't seek end of file.\n");
+            fclose(file);
             return nullptr;
         }
         off_t fileSize = ftell(file);
         if (fileSize == -1) {
             fprintf(stderr, "Couldn't tell the size of the file.\n");
+            fclose(file);
             return nullptr;
         }
         if (fseek(file, 0, SEEK_SET) == -1) {
             fprintf(stderr, "Couldn't seek start of file.\n");
+            fclose(file);
             return nullptr;
         }
 
@@ -34,6 +40,8 @@ namespace utils {
         size_t readCount = fread(buf, 1, bufSize, file);
         if (ferror(file) != 0) {
             fprintf(stderr, "Couldn't read file.\n");
+            delete[] buf;
+            buf = nullptr;
         } else {
             buf[readCount] = '\0';
         }
@@ -62,10 +70,15 @@ namespace utils {
     }
 
     bool loadShader(GLuint& shader, const GLenum shaderType, const char* path) {
-        const char* buf = readFileToBuffer(path);
+        FileView source;
+        if (!source.open(path)) {
+            return false;
+        }
+        const char* sourceStr = source.data();
+        GLint sourceLen = static_cast<GLint>(source.size());
         shader = glCreateShader(shaderType);
-        glShaderSource(shader, 1, &buf, nullptr);
-        delete[] buf;
+        glShaderSource(shader, 1, &sourceStr, &sourceLen);
+        source.close();
 
         glCompileShader(shader);
         GLint compileStatus = 0;
@@ -105,10 +118,14 @@ namespace utils {
     }
 
     bool createShaderFromString(GLuint& shader, const GLenum shaderType, const char* shaderStr) {
+        TRACE_FUNCTION();
         shader = glCreateShader(shaderType);
         glShaderSource(shader, 1, &shaderStr, nullptr);
         glCompileShader(shader);
+        return checkCompileStatus(shader, shaderType);
+    }
 
+    bool checkCompileStatus(GLuint shader, const GLenum shaderType) {
         GLint status = 0;
         glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
         if (status == GL_FALSE) {
@@ -126,6 +143,9 @@ namespace utils {
                 case GL_FRAGMENT_SHADER: {
                     shaderTypeStr = "fragment";
                 } break;
+                case GL_COMPUTE_SHADER: {
+                    shaderTypeStr = "compute";
+                } break;
                 default: {
                     shaderTypeStr = "unknown";
                 }
@@ -141,6 +161,14 @@ namespace utils {
 
     bool linkProgram(GLuint& program) {
         glLinkProgram(program);
+        if (!checkLinkStatus(program)) {
+            glDeleteProgram(program);
+            return false;
+        }
+        return true;
+    }
+
+    bool checkLinkStatus(GLuint program) {
         GLint linked = 0;
         glGetProgramiv(program, GL_LINK_STATUS, &linked);
         if (linked == GL_FALSE) {
@@ -151,13 +179,13 @@ namespace utils {
             glGetProgramInfoLog(program, logLen, nullptr, logBuffer);
             fprintf(stderr, "OpenGL failed to link program due to: %s\n", logBuffer);
             delete[] logBuffer;
-            glDeleteProgram(program);
             return false;
         }
         return true;
     }
 
     bool createProgram(GLuint& program, GLuint* shaders, const size_t numShaders) {
+        TRACE_FUNCTION();
         program = glCreateProgram();
         for (size_t idx = 0; idx < numShaders; idx++) {
             glAttachShader(program, shaders[idx]);
@@ -217,6 +245,57 @@ namespace utils {
         }
     }
 
+    const char* findArgValue(int argc, char** argv, const char* name) {
+        size_t nameLen = strlen(name);
+        for (int idx = 1; idx < argc; idx++) {
+            if (strncmp(argv[idx], name, nameLen) == 0 && argv[idx][nameLen] == '=') {
+                return argv[idx] + nameLen + 1;
+            }
+        }
+        return nullptr;
+    }
+
+    bool hasArg(int argc, char** argv, const char* name) {
+        for (int idx = 1; idx < argc; idx++) {
+            if (strcmp(argv[idx], name) == 0) {
+                return true;
+            }
+        }
+        return findArgValue(argc, argv, name) != nullptr;
+    }
+
+    size_t parseArgSize(
+        int argc,
+        char** argv,
+        const char* name,
+        size_t defaultValue,
+        size_t maxValue) {
+        const char* valueStr = findArgValue(argc, argv, name);
+        if (!valueStr) {
+            return defaultValue;
+        }
+
+        // `strtoull` negates values with a leading minus sign, rather than rejecting them.
+        char* end = nullptr;
+        unsigned long long value = strtoull(valueStr, &end, 10);
+        if (valueStr[0] < '0' || valueStr[0] > '9' || *end != '\0' || value > maxValue) {
+            fprintf(stderr, "Invalid value '%s' for option %s, using default.\n", valueStr, name);
+            return defaultValue;
+        }
+        return static_cast<size_t>(value);
+    }
+
+    uint64_t hashBytes(uint64_t seed, const void* data, size_t size) {
+        const uint64_t kFnvPrime = 1099511628211ULL;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = seed;
+        for (size_t idx = 0; idx < size; idx++) {
+            hash ^= bytes[idx];
+            hash *= kFnvPrime;
+        }
+        return hash;
+    }
+
     GLFWwindow* initGLFW(const char* windowName) {
         if (!windowName) {
             fprintf(stderr, "initGLFW() requires a window name argument.\n");
@@ -230,6 +309,8 @@ namespace utils {
             exit(-1);
         }
 
+        // Depth buffer of the default framebuffer, for the demos testing depth.
+        glfwWindowHint(GLFW_DEPTH_BITS, 24);
         GLFWwindow* window = glfwCreateWindow(
             utils::kWindowWidth, utils::kWindowHeight, windowName, nullptr, nullptr);
         if (!window) {
@@ -5,6 +5,9 @@
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define PI 3.14159F
 #define Bit(x) (1 << x)
 
@@ -14,6 +17,9 @@ namespace utils {
     // GLFW window height.
     static const int kWindowHeight = 800;
 
+    // Offset basis of the 64-bit FNV-1a hash, the seed of a hash over a single block of memory.
+    static const uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+
     enum CallbackOptions {
         KEY_CALLBACK = Bit(0),
         RESIZE_CALLBACK = Bit(1),
@@ -25,7 +31,8 @@ namespace utils {
      *
      * @param path Path to the file to be read.
      * @return Pointer to the buffer containing the content of the file. This pointer can be null if
-     * the function was unable to read the contents.
+     * the function was unable to read the contents. The buffer must be released with `delete[]`.
+     * Prefer `FileView`, which avoids the copy by mapping the file.
      */
     const char* readFileToBuffer(const char* path);
 
@@ -60,9 +67,25 @@ namespace utils {
      */
     bool createShaderFromString(GLuint& shader, const GLenum shaderType, const char* shaderStr);
 
+    /**
+     * @brief Checks whether a shader compiled successfully, reporting its info log otherwise. The
+     *        query blocks until the compilation finishes.
+     *
+     * @param shader Shader object whose compilation was requested.
+     * @param shaderType Type of the shader, used in the error report.
+     * @return True if the shader compiled successfully.
+     */
+    bool checkCompileStatus(GLuint shader, const GLenum shaderType);
+
     /** @brief Conduces the linking of a given program object. */
     bool linkProgram(GLuint& program);
 
+    /**
+     * @brief Checks whether a program linked successfully, reporting its info log otherwise. The
+     *        query blocks until the link finishes.
+     */
+    bool checkLinkStatus(GLuint program);
+
     /**
      * @brief Creates an OpenGL program object out of an array of shaders.
      *
@@ -102,6 +125,54 @@ namespace utils {
      */
     void setGLFWCallbacks(GLFWwindow* window, int flags);
 
+    /**
+     * @brief Checks whether a command line flag, either `--name` or `--name=value`, was passed to
+     *        the program.
+     *
+     * @param argc Number of command line arguments.
+     * @param argv Command line arguments.
+     * @param name Name of the flag, including the leading dashes.
+     * @return True if the flag is present.
+     */
+    bool hasArg(int argc, char** argv, const char* name);
+
+    /**
+     * @brief Finds the value of a command line option given as `--name=value`.
+     *
+     * @param argc Number of command line arguments.
+     * @param argv Command line arguments.
+     * @param name Name of the option, including the leading dashes.
+     * @return Pointer to the value of the option, or null if the option is not present.
+     */
+    const char* findArgValue(int argc, char** argv, const char* name);
+
+    /**
+     * @brief Parses an unsigned integer command line option given as `--name=value`.
+     *
+     * @param argc Number of command line arguments.
+     * @param argv Command line arguments.
+     * @param name Name of the option, including the leading dashes.
+     * @param defaultValue Value returned if the option is missing or malformed.
+     * @param maxValue Largest accepted value, larger ones are malformed, as are negative ones.
+     * @return Value of the option.
+     */
+    size_t parseArgSize(
+        int argc,
+        char** argv,
+        const char* name,
+        size_t defaultValue,
+        size_t maxValue = SIZE_MAX);
+
+    /**
+     * @brief 64-bit FNV-1a hash of a block of memory, continuing from `seed`, so that several
+     *        blocks can be hashed as one by chaining the calls.
+     *
+     * @param seed `kFnvOffsetBasis`, or the hash of the preceding blocks.
+     * @param data Block of memory hashed.
+     * @param size Size of the block in bytes.
+     */
+    uint64_t hashBytes(uint64_t seed, const void* data, size_t size);
+
     /**
      * @brief Initialize GLFW.
      *
@@ -0,0 +1,269 @@
+#include "vertexFormat.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace vertex {
+    // Components of each position and color in the planar source data.
+    static const size_t kComponents = 3;
+
+    static size_t positionSize(PositionFormat format) {
+        switch (format) {
+            case PositionFormat::FLOAT32:
+                return kComponents * sizeof(float);
+            case PositionFormat::HALF:
+            case PositionFormat::SNORM16:
+                // Padded with a fourth component to keep the colors 4-byte aligned.
+                return 4 * sizeof(uint16_t);
+        }
+        return 0;
+    }
+
+    static size_t colorSize(ColorFormat format) {
+        switch (format) {
+            case ColorFormat::FLOAT32:
+                return kComponents * sizeof(float);
+            case ColorFormat::RGBA8:
+            case ColorFormat::RGB10_A2:
+                return sizeof(uint32_t);
+        }
+        return 0;
+    }
+
+    size_t vertexSize(Format format) {
+        return positionSize(format.position) + colorSize(format.color);
+    }
+
+    bool parsePositionFormat(const char* name, PositionFormat& format) {
+        if (strcmp(name, "float") == 0) {
+            format = PositionFormat::FLOAT32;
+        } else if (strcmp(name, "half") == 0) {
+            format = PositionFormat::HALF;
+        } else if (strcmp(name, "snorm16") == 0) {
+            format = PositionFormat::SNORM16;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool parseColorFormat(const char* name, ColorFormat& format) {
+        if (strcmp(name, "float") == 0) {
+            format = ColorFormat::FLOAT32;
+        } else if (strcmp(name, "rgba8") == 0) {
+            format = ColorFormat::RGBA8;
+        } else if (strcmp(name, "rgb10a2") == 0) {
+            format = ColorFormat::RGB10_A2;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    const char* positionFormatName(PositionFormat format) {
+        switch (format) {
+            case PositionFormat::FLOAT32:
+                return "float";
+            case PositionFormat::HALF:
+                return "half";
+            case PositionFormat::SNORM16:
+                return "snorm16";
+        }
+        return "unknown";
+    }
+
+    const char* colorFormatName(ColorFormat format) {
+        switch (format) {
+            case ColorFormat::FLOAT32:
+                return "float";
+            case ColorFormat::RGBA8:
+                return "rgba8";
+            case ColorFormat::RGB10_A2:
+                return "rgb10a2";
+        }
+        return "unknown";
+    }
+
+    uint16_t floatToHalf(float value) {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t exponent = (bits >> 23) & 0xFF;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        // Infinities stay infinite and NaNs stay quiet NaNs.
+        if (exponent == 0xFF) {
+            return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+        }
+
+        int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+        if (halfExponent >= 0x1F) {
+            return static_cast<uint16_t>(sign | 0x7C00);
+        }
+
+        if (halfExponent <= 0) {
+            // Subnormal half, or zero if even rounding can't reach the smallest subnormal.
+            if (halfExponent < -10) {
+                return static_cast<uint16_t>(sign);
+            }
+            mantissa |= 0x800000;
+            uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+            uint32_t halfMantissa = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1U << shift) - 1);
+            uint32_t halfway = 1U << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (halfMantissa & 1) != 0)) {
+                halfMantissa++;
+            }
+            return static_cast<uint16_t>(sign | halfMantissa);
+        }
+
+        uint32_t result = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFF;
+        // A carry out of the mantissa correctly bumps the exponent, up to infinity.
+        if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1) != 0)) {
+            result++;
+        }
+        return static_cast<uint16_t>(result);
+    }
+
+    int16_t floatToSnorm16(float value) {
+        float clamped = fminf(fmaxf(value, -1.0F), 1.0F);
+        return static_cast<int16_t>(lrintf(clamped * 32767.0F));
+    }
+
+    /** @brief Converts a float in [0, 1] to an unsigned normalized integer of `maxValue` steps. */
+    static uint32_t floatToUnorm(float value, float maxValue) {
+        float clamped = fminf(fmaxf(value, 0.0F), 1.0F);
+        return static_cast<uint32_t>(lrintf(clamped * maxValue));
+    }
+
+    uint32_t packRGBA8(float r, float g, float b, float a) {
+        return floatToUnorm(r, 255.0F) | (floatToUnorm(g, 255.0F) << 8) |
+               (floatToUnorm(b, 255.0F) << 16) | (floatToUnorm(a, 255.0F) << 24);
+    }
+
+    uint32_t packRGB10A2(float r, float g, float b, float a) {
+        return floatToUnorm(r, 1023.0F) | (floatToUnorm(g, 1023.0F) << 10) |
+               (floatToUnorm(b, 1023.0F) << 20) | (floatToUnorm(a, 3.0F) << 30);
+    }
+
+    float positionScale(PositionFormat format, const float* positions, size_t numVertices) {
+        if (format != PositionFormat::SNORM16) {
+            return 1.0F;
+        }
+        float maxAbs = 0.0F;
+        for (size_t idx = 0; idx < kComponents * numVertices; idx++) {
+            maxAbs = fmaxf(maxAbs, fabsf(positions[idx]));
+        }
+        return maxAbs > 0.0F ? maxAbs : 1.0F;
+    }
+
+    void packVertices(
+        Format format,
+        const float* positions,
+        const float* colors,
+        size_t numVertices,
+        float scale,
+        void* dst) {
+        uint8_t* out = static_cast<uint8_t*>(dst);
+        size_t posSize = positionSize(format.position);
+        size_t stride = vertexSize(format);
+        float invScale = 1.0F / scale;
+
+        for (size_t vtx = 0; vtx < numVertices; vtx++) {
+            const float* pos = positions + kComponents * vtx;
+            const float* col = colors + kComponents * vtx;
+            uint8_t* vertex = out + stride * vtx;
+
+            switch (format.position) {
+                case PositionFormat::FLOAT32: {
+                    memcpy(vertex, pos, kComponents * sizeof(float));
+                } break;
+                case PositionFormat::HALF: {
+                    uint16_t packed[4] = {
+                        floatToHalf(pos[0] * invScale),
+                        floatToHalf(pos[1] * invScale),
+                        floatToHalf(pos[2] * invScale),
+                        0};
+                    memcpy(vertex, packed, sizeof(packed));
+                } break;
+                case PositionFormat::SNORM16: {
+                    int16_t packed[4] = {
+                        floatToSnorm16(pos[0] * invScale),
+                        floatToSnorm16(pos[1] * invScale),
+                        floatToSnorm16(pos[2] * invScale),
+                        0};
+                    memcpy(vertex, packed, sizeof(packed));
+                } break;
+            }
+
+            switch (format.color) {
+                case ColorFormat::FLOAT32: {
+                    memcpy(vertex + posSize, col, kComponents * sizeof(float));
+                } break;
+                case ColorFormat::RGBA8: {
+                    uint32_t packed = packRGBA8(col[0], col[1], col[2], 1.0F);
+                    memcpy(vertex + posSize, &packed, sizeof(packed));
+                } break;
+                case ColorFormat::RGB10_A2: {
+                    uint32_t packed = packRGB10A2(col[0], col[1], col[2], 1.0F);
+                    memcpy(vertex + posSize, &packed, sizeof(packed));
+                } break;
+            }
+        }
+    }
+
+    void describeFormat(
+        Format format,
+        GLuint positionLoc,
+        GLuint colorLoc,
+        GLuint bindingIdx,
+        Attrib attribs[2],
+        Binding& binding) {
+        Attrib& position = attribs[0];
+        position.location = positionLoc;
+        position.size = static_cast<GLint>(kComponents);
+        position.relativeOffset = 0;
+        position.binding = bindingIdx;
+        switch (format.position) {
+            case PositionFormat::FLOAT32: {
+                position.type = GL_FLOAT;
+                position.normalized = GL_FALSE;
+            } break;
+            case PositionFormat::HALF: {
+                position.type = GL_HALF_FLOAT;
+                position.normalized = GL_FALSE;
+            } break;
+            case PositionFormat::SNORM16: {
+                position.type = GL_SHORT;
+                position.normalized = GL_TRUE;
+            } break;
+        }
+
+        Attrib& color = attribs[1];
+        color.location = colorLoc;
+        color.relativeOffset = static_cast<GLuint>(positionSize(format.position));
+        color.binding = bindingIdx;
+        switch (format.color) {
+            case ColorFormat::FLOAT32: {
+                color.size = static_cast<GLint>(kComponents);
+                color.type = GL_FLOAT;
+                color.normalized = GL_FALSE;
+            } break;
+            case ColorFormat::RGBA8: {
+                color.size = 4;
+                color.type = GL_UNSIGNED_BYTE;
+                color.normalized = GL_TRUE;
+            } break;
+            case ColorFormat::RGB10_A2: {
+                color.size = 4;
+                color.type = GL_UNSIGNED_INT_2_10_10_10_REV;
+                color.normalized = GL_TRUE;
+            } break;
+        }
+
+        binding.index = bindingIdx;
+        binding.stride = static_cast<GLsizei>(vertexSize(format));
+        binding.divisor = 0;
+    }
+}  // namespace vertex
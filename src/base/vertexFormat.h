@@ -0,0 +1,126 @@
+#ifndef RENDEER_VERTEX_FORMAT_HEADER
+#define RENDEER_VERTEX_FORMAT_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vertexLayout.h"
+
+namespace vertex {
+    // Encoding of the vertex positions, three components each.
+    enum class PositionFormat {
+        // 32-bit floats, 12 bytes.
+        FLOAT32,
+        // 16-bit floats, 6 bytes padded to 8.
+        HALF,
+        // 16-bit signed normalized integers, 6 bytes padded to 8. The positions are divided by a
+        // scale mapping them into [-1, 1], which the vertex shader multiplies back.
+        SNORM16,
+    };
+
+    // Encoding of the vertex colors, RGB with an opaque alpha channel where present.
+    enum class ColorFormat {
+        // 32-bit floats, RGB only, 12 bytes.
+        FLOAT32,
+        // 8-bit unsigned normalized RGBA, 4 bytes.
+        RGBA8,
+        // 10-bit unsigned normalized RGB and 2-bit alpha, packed into 4 bytes.
+        RGB10_A2,
+    };
+
+    // Interleaved vertex format: the position of each vertex is followed by its color.
+    struct Format {
+        PositionFormat position;
+        ColorFormat color;
+    };
+
+    // Largest size in bytes of an interleaved vertex.
+    static const size_t kMaxVertexSize = 24;
+
+    // Format of the original planar vertex data, 24 bytes per vertex.
+    static const Format kUnquantizedFormat = {PositionFormat::FLOAT32, ColorFormat::FLOAT32};
+
+    /** @brief Size in bytes of a single interleaved vertex, a multiple of 4. */
+    size_t vertexSize(Format format);
+
+    /**
+     * @brief Parses a position format name: `float`, `half` or `snorm16`.
+     *
+     * @return False if the name is unknown, leaving `format` untouched.
+     */
+    bool parsePositionFormat(const char* name, PositionFormat& format);
+
+    /**
+     * @brief Parses a color format name: `float`, `rgba8` or `rgb10a2`.
+     *
+     * @return False if the name is unknown, leaving `format` untouched.
+     */
+    bool parseColorFormat(const char* name, ColorFormat& format);
+
+    const char* positionFormatName(PositionFormat format);
+    const char* colorFormatName(ColorFormat format);
+
+    /** @brief Converts a float to a half float, rounding to the nearest even. */
+    uint16_t floatToHalf(float value);
+
+    /** @brief Converts a float in [-1, 1] to a 16-bit signed normalized integer. */
+    int16_t floatToSnorm16(float value);
+
+    /** @brief Packs a color with components in [0, 1] as 8-bit RGBA, red in the lowest byte. */
+    uint32_t packRGBA8(float r, float g, float b, float a);
+
+    /**
+     * @brief Packs a color with components in [0, 1] as `GL_UNSIGNED_INT_2_10_10_10_REV`, red in
+     *        the lowest bits.
+     */
+    uint32_t packRGB10A2(float r, float g, float b, float a);
+
+    /**
+     * @brief Scale dividing the positions before they are encoded, the largest absolute component
+     *        for `SNORM16` and one otherwise.
+     *
+     * @param format Encoding of the positions.
+     * @param positions Three floats per vertex.
+     * @param numVertices Number of vertices.
+     */
+    float positionScale(PositionFormat format, const float* positions, size_t numVertices);
+
+    /**
+     * @brief Encodes planar positions and colors into interleaved vertices.
+     *
+     * @param format Interleaved vertex format.
+     * @param positions Three floats per vertex.
+     * @param colors Three floats per vertex, RGB in [0, 1].
+     * @param numVertices Number of vertices.
+     * @param scale Scale dividing the positions, see `positionScale`.
+     * @param dst Destination of `numVertices * vertexSize(format)` bytes.
+     */
+    void packVertices(
+        Format format,
+        const float* positions,
+        const float* colors,
+        size_t numVertices,
+        float scale,
+        void* dst);
+
+    /**
+     * @brief Describes the attributes of an interleaved vertex format, fetched from a single
+     *        buffer binding.
+     *
+     * @param format Interleaved vertex format.
+     * @param positionLoc Layout location of the position attribute.
+     * @param colorLoc Layout location of the color attribute.
+     * @param bindingIdx Index of the buffer binding.
+     * @param attribs Receives the position and color attributes, in that order.
+     * @param binding Receives the buffer binding.
+     */
+    void describeFormat(
+        Format format,
+        GLuint positionLoc,
+        GLuint colorLoc,
+        GLuint bindingIdx,
+        Attrib attribs[2],
+        Binding& binding);
+}  // namespace vertex
+
+#endif  // RENDEER_VERTEX_FORMAT_HEADER
@@ -0,0 +1,39 @@
+#include "vertexLayout.h"
+
+#include <stdio.h>
+
+namespace vertex {
+    GLuint createVertexArray(const Layout& layout) {
+        GLuint vao = 0;
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+
+        for (size_t idx = 0; idx < layout.numAttribs; idx++) {
+            const Attrib& attrib = layout.attribs[idx];
+            glVertexAttribFormat(
+                attrib.location,
+                attrib.size,
+                attrib.type,
+                attrib.normalized,
+                attrib.relativeOffset);
+            glVertexAttribBinding(attrib.location, attrib.binding);
+            glEnableVertexAttribArray(attrib.location);
+        }
+        for (size_t idx = 0; idx < layout.numBindings; idx++) {
+            glVertexBindingDivisor(layout.bindings[idx].index, layout.bindings[idx].divisor);
+        }
+
+        return vao;
+    }
+
+    bool bindVertexBuffer(const Layout& layout, GLuint binding, GLuint buffer, GLintptr offset) {
+        for (size_t idx = 0; idx < layout.numBindings; idx++) {
+            if (layout.bindings[idx].index == binding) {
+                glBindVertexBuffer(binding, buffer, offset, layout.bindings[idx].stride);
+                return true;
+            }
+        }
+        fprintf(stderr, "The vertex layout has no buffer binding %u.\n", binding);
+        return false;
+    }
+}  // namespace vertex
@@ -0,0 +1,71 @@
+#ifndef RENDEER_VERTEX_LAYOUT_HEADER
+#define RENDEER_VERTEX_LAYOUT_HEADER
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <stddef.h>
+
+namespace vertex {
+    // Format of a single vertex attribute.
+    struct Attrib {
+        // Layout location of the attribute in the vertex shader.
+        GLuint location;
+        // Number of components, from 1 to 4.
+        GLint size;
+        // Type of the components, such as `GL_FLOAT` or `GL_UNSIGNED_BYTE`.
+        GLenum type;
+        // Whether integer components are normalized to [0, 1] or [-1, 1].
+        GLboolean normalized;
+        // Offset in bytes of the attribute from the start of the vertex.
+        GLuint relativeOffset;
+        // Index of the buffer binding the attribute is fetched from.
+        GLuint binding;
+    };
+
+    // Buffer binding point, shared by the attributes fetched from the same buffer.
+    struct Binding {
+        GLuint index;
+        // Distance in bytes between consecutive vertices.
+        GLsizei stride;
+        // Number of instances sharing an element, zero to advance per vertex.
+        GLuint divisor;
+    };
+
+    /**
+     * @brief Description of the vertex attributes fetched by a vertex shader, and the buffer
+     *        bindings they are fetched from. The format is fully independent of the buffers, which
+     *        are only attached to the bindings afterwards, so that a vertex array object is built
+     *        once and drawn with a single bind.
+     */
+    struct Layout {
+        const Attrib* attribs;
+        size_t numAttribs;
+        const Binding* bindings;
+        size_t numBindings;
+    };
+
+    /**
+     * @brief Creates a vertex array object and specifies the format of every attribute of a
+     *        layout, with the separate attribute formats of OpenGL 4.3. The vertex array is left
+     *        bound, so that `bindVertexBuffer` can attach its buffers.
+     *
+     * @param layout Description of the vertex attributes.
+     * @return Name of the vertex array object.
+     */
+    GLuint createVertexArray(const Layout& layout);
+
+    /**
+     * @brief Attaches a buffer to a binding of the bound vertex array object.
+     *
+     * @param layout Layout the vertex array was created with, providing the stride.
+     * @param binding Index of the binding.
+     * @param buffer Buffer object holding the vertices.
+     * @param offset Offset in bytes of the first vertex in the buffer.
+     * @return False if the layout has no such binding.
+     */
+    bool bindVertexBuffer(const Layout& layout, GLuint binding, GLuint buffer, GLintptr offset);
+}  // namespace vertex
+
+#endif  // RENDEER_VERTEX_LAYOUT_HEADER
@@ -2,9 +2,32 @@
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
 
+#include <math.h>
+#include <stddef.h>
 #include <stdio.h>
-
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "base/arena.h"
+#include "base/benchmark.h"
+#include "base/culling.h"
+#include "base/display.h"
+#include "base/drawBatch.h"
+#include "base/drawSort.h"
+#include "base/frameStats.h"
+#include "base/glState.h"
+#include "base/gpuProfiler.h"
+#include "base/jobs.h"
+#include "base/linalg.h"
+#include "base/mesh.h"
+#include "base/programCache.h"
+#include "base/streamBuffer.h"
+#include "base/trace.h"
+#include "base/uniformRing.h"
 #include "base/utils.h"
+#include "base/vertexFormat.h"
+#include "base/vertexLayout.h"
 
 // Total number of vertices in the scene.
 const size_t kNumVertices = 36;
@@ -125,11 +148,8 @@ const float kInitialVertexData[(kPositionDataPerVertex + kColorDataPerVertex) *
     // clang-format on
 };
 
-// Size of the array containing the data of the vertices (positions and colors).
-const size_t kVertexDataSize = sizeof(kInitialVertexData);
-
 // Offset into the array of vertex data that points to the color data of the vertices (last half).
-const size_t kColorDataOffset = kVertexDataSize / 2;
+const size_t kColorDataOffset = kNumVertices * kPositionDataPerVertex;
 
 // Vertex array object.
 static GLuint sVAO = 0;
@@ -137,46 +157,364 @@ static GLuint sVAO = 0;
 // Vertex buffer object.
 static GLuint sVBO = 0;
 
+// Index buffer object, holding `kNumVertices` indices into the welded vertices of `sVBO`.
+static GLuint sIBO = 0;
+
+// Per-instance attributes of each box: offset and scale, and a tint multiplying its colors.
+struct BoxInstance {
+    float offset[3];
+    float scale;
+    uint32_t tint;
+};
+
+// Number of boxes drawn, selected at startup with `--boxes=N`.
+static size_t sNumBoxes = 1;
+
+// Per-draw data of each box in the multi-draw mode, matching the `std430` layout of `BoxDrawData`
+// in the vertex shader.
+struct BoxDrawData {
+    // Offset in `xyz` and scale in `w`.
+    float transform[4];
+    float tint[4];
+};
+
+// Way the boxes are submitted, so that the cost of the draw calls can be compared.
+enum class DrawMode {
+    // A single instanced draw call, the default.
+    INSTANCED,
+    // One draw call per box, with `--draw-per-box`, running the very same shader.
+    PER_BOX,
+    // A single multi-draw indirect call, with `--multi-draw`, alternating between two different
+    // meshes whose per-draw data is fetched with `gl_DrawID`.
+    MULTI_DRAW,
+};
+static DrawMode sDrawMode = DrawMode::INSTANCED;
+
+// Side of the square grid over which the boxes are laid out, relative to the original box,
+// selected at startup with `--grid-extent=F`. Large grids spill out of the view frustum.
+static float sBoxGridExtent = 1.0F;
+
+// Depth over which the boxes are spread along the view direction, so that they hide one another,
+// selected at startup with `--grid-depth=F`.
+static float sGridDepth = 0.0F;
+
+// Whether the boxes are sorted front-to-back every frame, with `--sort`, so that the early depth
+// test rejects the fragments of the hidden ones.
+static bool sSortDraws = false;
+
+// Whether every shaded fragment is counted rather than colored, with `--overdraw`.
+static bool sOverdraw = false;
+
+// Fragment counts read back by `measureOverdraw`, allocated at startup for the framebuffer, and
+// only allocated again if the window grows.
+static memory::Arena sOverdrawArena;
+
+// Culling of the instances against the view frustum, only available with the instanced draw.
+enum class CullMode {
+    NONE,
+    // Culled by `sCullProgram`, with `--gpu-cull`.
+    GPU,
+    // Culled on the CPU by the `culling` module across `sJobSystem`, with `--cpu-cull`.
+    CPU,
+};
+static CullMode sCullMode = CullMode::NONE;
+
+// Instances of every box, kept on the CPU for culling and sorting, and indices of the boxes drawn
+// in the frame, in draw order.
+static memory::Arena sInstanceArena;
+static BoxInstance* sInstances = nullptr;
+static uint32_t* sVisibleIndices = nullptr;
+
+// Distance of every box from the camera along the view direction, and its per-draw data in the
+// multi-draw mode, whose draws are rebuilt in sorted order.
+static float* sBoxDepths = nullptr;
+static BoxDrawData* sBoxDrawData = nullptr;
+
+// Sort keys of the boxes drawn in the frame, and scratch memory of the sort.
+static sorting::DrawItem* sDrawItems = nullptr;
+static sorting::DrawItem* sDrawScratch = nullptr;
+
+// Bounds of every box, and view frustum they are culled against, in world space.
+static culling::BoundsStore sBoxBounds;
+static culling::Frustum sFrustum = {};
+
+// Stream buffer receiving the instances of the boxes drawn every frame, when culled on the CPU or
+// sorted.
+static stream::StreamBuffer sVisibleInstanceStream;
+
+// Pool of threads sharing the culling.
+static jobs::JobSystem* sJobSystem = nullptr;
+
+// Number of boxes kept by the CPU culling in the last frame.
+static size_t sNumVisible = 0;
+
+// Buffer object receiving the `BoxInstance` of the visible boxes, compacted by `sCullProgram`.
+static GLuint sVisibleInstanceBuffer = 0;
+
+// Buffer object holding the `DrawElementsIndirectCommand` of the culled draw, whose instance count
+// is written by `sCullProgram`.
+static GLuint sCullCommandBuffer = 0;
+
+// Buffer object holding a `BoxInstance` per box.
+static GLuint sInstanceBuffer = 0;
+
+// Batch holding the meshes of the multi-draw mode: the whole box, and the box without its front
+// and back faces.
+static batch::MeshBatch sMeshBatch;
+static batch::MeshRange sBoxMesh = {};
+static batch::MeshRange sTubeMesh = {};
+
+// First vertex of the tube mesh in `kInitialVertexData`, the front and back faces coming first.
+static const size_t kTubeFirstVertex = 12;
+
+// Binding point of the `DrawData` shader storage block.
+static const GLuint kDrawDataBinding = 0;
+
 // Program object.
 static GLuint sGLProgram = 0;
 
+// Shadow of the bindings of the context, dropping the redundant ones.
+static glstate::StateCache sGLState;
+
+// Timings of the last frames, reported once per second and at exit. The culling and sorting of the
+// boxes on the CPU are timed as the update of the scene.
+static telemetry::FrameStats sFrameStats;
+
+// GPU timings of the frame, and of the culling pass within it with `--gpu-cull`.
+static profiling::GpuProfiler sGpuProfiler;
+
+// Window, or offscreen framebuffer with `--headless`, the frames are rendered to.
+static display::Display sDisplay;
+
+// On-disk cache of the linked programs, see `--shader-cache=DIR` and `--no-shader-cache`.
+static shaders::ProgramCache sProgramCache;
+
 // String representation of the vertex shader.
 static const char* kVertexShaderStr =
     R"glsl(#version 460
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inCol;
+layout(location = 2) in vec4 instanceTransform;
+layout(location = 3) in vec3 instanceTint;
+
+layout(std140, binding = 0) uniform Camera {
+    mat4 perspectiveMat;
+    vec2 cameraOffset;
+};
+layout(location = 2) uniform float positionScale;
+
+
+layout(location = 0) out vec3 outCol;
+
+// Center of the original box, around which the instances are scaled.
+const vec3 boxCenter = vec3(0.0, 0.0, -2.0);
+
+void main() {
+    outCol = inCol * instanceTint;
+    vec3 boxPos = inPos * positionScale;
+    vec3 pos = boxCenter + (boxPos - boxCenter) * instanceTransform.w + instanceTransform.xyz;
+    vec4 cameraPos = vec4(pos + vec3(cameraOffset, 0.0), 1.0);
+    gl_Position =  perspectiveMat * cameraPos;
+}
+)glsl";
+
+// String representation of the vertex shader of the multi-draw mode, fetching the transform and
+// tint of each box from its per-draw data rather than from instanced attributes.
+static const char* kMultiDrawVertexShaderStr =
+    R"glsl(#version 460
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inCol;
+
+struct BoxDrawData {
+    vec4 transform;
+    vec4 tint;
+};
 
-layout(location = 0) uniform mat4 perspectiveMat;
-layout(location = 1) uniform vec2 cameraOffset;
+layout(std430, binding = 0) readonly buffer DrawData {
+    BoxDrawData boxes[];
+};
 
+layout(std140, binding = 0) uniform Camera {
+    mat4 perspectiveMat;
+    vec2 cameraOffset;
+};
+layout(location = 2) uniform float positionScale;
 
 layout(location = 0) out vec3 outCol;
 
+// Center of the original box, around which the boxes are scaled.
+const vec3 boxCenter = vec3(0.0, 0.0, -2.0);
+
 void main() {
-    outCol = inCol;
-    vec4 cameraPos = vec4(inPos + vec3(cameraOffset, 0.0), 1.0);
+    BoxDrawData box = boxes[gl_DrawID];
+    outCol = inCol * box.tint.rgb;
+    vec3 boxPos = inPos * positionScale;
+    vec3 pos = boxCenter + (boxPos - boxCenter) * box.transform.w + box.transform.xyz;
+    vec4 cameraPos = vec4(pos + vec3(cameraOffset, 0.0), 1.0);
     gl_Position =  perspectiveMat * cameraPos;
 }
 )glsl";
 
-// String representation of the fragment shader.
+// Compute shader culling the instances against the view frustum, in raw string representation.
+// Each invocation tests the bounding box of an instance and appends it to the visible instances if
+// it intersects the frustum, counting it in the indirect draw command. The instances are read as
+// raw words, since no `std430` structure matches the 20-byte `BoxInstance`.
+static const char* kCullShaderStr =
+    R"glsl(#version 460
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 0) readonly buffer Instances {
+    uint instances[];
+};
+layout(std430, binding = 1) writeonly buffer VisibleInstances {
+    uint visibleInstances[];
+};
+layout(std430, binding = 2) buffer Command {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std140, binding = 0) uniform Camera {
+    mat4 perspectiveMat;
+    vec2 cameraOffset;
+};
+layout(location = 2) uniform uint numInstances;
+layout(location = 3) uniform vec3 boxMin;
+layout(location = 4) uniform vec3 boxMax;
+
+// Center of the original box, around which the instances are scaled.
+const vec3 boxCenter = vec3(0.0, 0.0, -2.0);
+
+// Number of words of a single instance.
+const uint instanceWords = 5;
+
+void main() {
+    uint idx = gl_GlobalInvocationID.x;
+    if (idx >= numInstances) {
+        return;
+    }
+    uint first = instanceWords * idx;
+    vec4 transform = uintBitsToFloat(uvec4(
+        instances[first], instances[first + 1], instances[first + 2], instances[first + 3]));
+
+    // Bounds of the instance in camera space, transformed as in the vertex shader.
+    vec3 center = boxCenter + (0.5 * (boxMin + boxMax) - boxCenter) * transform.w;
+    center += transform.xyz + vec3(cameraOffset, 0.0);
+    vec3 extent = 0.5 * (boxMax - boxMin) * transform.w;
+
+    // Planes of the frustum, extracted from the rows of the projection (Gribb and Hartmann). The
+    // box is outside as soon as its corner closest to the inside of a plane lies behind it.
+    mat4 rows = transpose(perspectiveMat);
+    vec4 planes[6] = vec4[6](
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2]);
+    for (int plane = 0; plane < 6; plane++) {
+        vec3 normal = planes[plane].xyz;
+        if (dot(normal, center) + dot(abs(normal), extent) + planes[plane].w < 0.0) {
+            return;
+        }
+    }
+
+    uint slot = atomicAdd(instanceCount, 1);
+    for (uint word = 0; word < instanceWords; word++) {
+        visibleInstances[instanceWords * slot + word] = instances[first + word];
+    }
+}
+)glsl";
+
+// Number of invocations per work group of the culling shader, must match `local_size_x`.
+static const GLuint kCullWorkGroupSize = 64;
+
+// Layout locations of the uniforms of the culling shader, which reads the camera from the same
+// `Camera` block as the vertex shader.
+static const GLint kCullNumInstancesLoc = 2;
+static const GLint kCullBoxMinLoc = 3;
+static const GLint kCullBoxMaxLoc = 4;
+
+// Binding points of the shader storage blocks of the culling shader.
+static const GLuint kCullInstancesBinding = 0;
+static const GLuint kCullVisibleBinding = 1;
+static const GLuint kCullCommandBinding = 2;
+
+// Program object culling the instances, see `--gpu-cull`.
+static GLuint sCullProgram = 0;
+
+// String representation of the fragment shader. With a positive `overdrawStep`, every fragment
+// adds the step to the additively blended color instead, which counts the fragments shaded.
 static const char* kFragmentShaderStr =
     R"glsl(#version 460
 layout(location = 0) in vec3 inCol;
+layout(location = 3) uniform float overdrawStep;
 out vec4 outCol;
 
 void main() {
-    outCol = vec4(inCol, 1.0);
+    outCol = overdrawStep > 0.0 ? vec4(vec3(overdrawStep), 1.0) : vec4(inCol, 1.0);
 }
 )glsl";
 
-// Input attributes
-static GLuint sInPosLoc = 0;
-static GLuint sInColLoc = 0;
+// Layout location of the `overdrawStep` uniform.
+static const GLint kOverdrawStepLoc = 3;
+
+// Step added by each fragment in the overdraw mode, one unit of the 8-bit red channel, which
+// saturates at 255 fragments per pixel.
+static const float kOverdrawStep = 1.0F / 255.0F;
+
+// Interleaved vertex format of the vertex buffer, selected at startup with `--position-format`
+// and `--color-format`.
+static vertex::Format sVertexFormat = vertex::kUnquantizedFormat;
+
+// Layout locations of the input attributes of the vertex shader.
+static const GLuint kInPosLoc = 0;
+static const GLuint kInColLoc = 1;
+static const GLuint kInstanceTransformLoc = 2;
+static const GLuint kInstanceTintLoc = 3;
+
+// Buffer bindings of the per-vertex and per-instance attributes.
+static const GLuint kVertexBindingIdx = 0;
+static const GLuint kInstanceBindingIdx = 1;
+
+// Layout of the interleaved vertices, matching the `layout` qualifiers of the vertex shader. The
+// per-vertex attributes are filled in by `vertex::describeFormat`, the per-instance ones advance
+// once per box.
+static vertex::Attrib sVertexAttribs[4] = {
+    {},
+    {},
+    {kInstanceTransformLoc, 4, GL_FLOAT, GL_FALSE, 0, kInstanceBindingIdx},
+    {kInstanceTintLoc,
+     4,
+     GL_UNSIGNED_BYTE,
+     GL_TRUE,
+     offsetof(BoxInstance, tint),
+     kInstanceBindingIdx},
+};
+static vertex::Binding sVertexBindings[2] = {
+    {},
+    {kInstanceBindingIdx, sizeof(BoxInstance), 1},
+};
+static const vertex::Layout kVertexLayout = {sVertexAttribs, 4, sVertexBindings, 2};
+
+// Per-vertex part of `kVertexLayout`, used by the mesh batch of the multi-draw mode.
+static const vertex::Layout kMeshLayout = {sVertexAttribs, 2, sVertexBindings, 1};
 
-// Uniform inputs
-static GLuint sPerspectiveMatLoc = 0;
-static GLuint sCameraOffsetLoc = 0;
+// Layout location of the `positionScale` uniform, scaling the decoded positions back.
+static const GLint kPositionScaleLoc = 2;
+
+// Contents of the `Camera` uniform block shared by every program, following the `std140` layout.
+struct CameraBlock {
+    float perspectiveMat[16];
+    float cameraOffset[2];
+    float padding[2];
+};
+
+// Binding point of the `Camera` uniform block.
+static const GLuint kCameraBinding = 0;
+
+// Ring of per-frame uniform blocks, from which the camera is allocated every frame.
+static uniforms::UniformRing sUniformRing;
 
 static const float kFrustumScale = 1.0F;
 static const float kZCameraNear = 0.5F;
@@ -193,77 +531,553 @@ static float sPerspectiveMat[16] = {
     // clang-format on
 };
 
-/** Generates and compiles shaders, and generates, compile and liks the program object. */
+/** Creates the program object, restoring it from `sProgramCache` when possible. */
 bool initProgram() {
-    GLuint shaders[2] = {0};
-    if (!(utils::createShaderFromString(shaders[0], GL_VERTEX_SHADER, kVertexShaderStr) &&
-          utils::createShaderFromString(shaders[1], GL_FRAGMENT_SHADER, kFragmentShaderStr))) {
-        fprintf(stderr, "Unable to create shaders from the given string.\n");
+    const shaders::ShaderSource sources[2] = {
+        {GL_VERTEX_SHADER,
+         sDrawMode == DrawMode::MULTI_DRAW ? kMultiDrawVertexShaderStr : kVertexShaderStr},
+        {GL_FRAGMENT_SHADER, kFragmentShaderStr},
+    };
+    shaders::ProgramDesc desc = {sources, 2, nullptr, 0, GL_NONE};
+    if (!shaders::createProgram(sGLProgram, desc, &sProgramCache)) {
+        fprintf(stderr, "Unable to create program.\n");
         return false;
     }
 
-    if (!utils::createProgram(sGLProgram, shaders, 2)) {
-        fprintf(stderr, "Unable to create program.\n");
+    if (sCullMode == CullMode::GPU) {
+        const shaders::ShaderSource cullSources[1] = {{GL_COMPUTE_SHADER, kCullShaderStr}};
+        shaders::ProgramDesc cullDesc = {cullSources, 1, nullptr, 0, GL_NONE};
+        if (!shaders::createProgram(sCullProgram, cullDesc, &sProgramCache)) {
+            fprintf(stderr, "Unable to create the culling program.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Welds the duplicate vertices of an unindexed triangle list into an index buffer, whose triangles
+ * are reordered for the post-transform cache, and the vertices for the fetch. `weldedACMR` receives
+ * the ACMR of the welded indices, before the triangles are reordered.
+ *
+ * @return Number of unique vertices, written to `uniqueVertices`.
+ */
+size_t indexVertices(
+    const uint8_t* vertices,
+    size_t numVertices,
+    size_t vertexSize,
+    uint32_t* indices,
+    uint8_t* uniqueVertices,
+    float& weldedACMR) {
+    size_t numUnique =
+        mesh::weldVertices(vertices, numVertices, vertexSize, indices, uniqueVertices);
+    weldedACMR = mesh::computeACMR(indices, numVertices);
+    mesh::optimizeVertexCache(indices, numVertices, numUnique);
+    return mesh::optimizeVertexFetch(uniqueVertices, indices, numVertices, numUnique, vertexSize);
+}
+
+/**
+ * Adds the box and the tube meshes to `sMeshBatch`, both cut out of the same packed vertices.
+ *
+ * @return False if the batch couldn't be created.
+ */
+bool initMeshBatch(const uint8_t* packedVertices, size_t vertexSize) {
+    if (!sMeshBatch.init(
+            kMeshLayout,
+            kVertexBindingIdx,
+            2 * kNumVertices,
+            2 * kNumVertices,
+            sNumBoxes,
+            sizeof(BoxDrawData))) {
         return false;
     }
+    glBindVertexArray(0);
+    sGLState.invalidate();
+
+    uint8_t uniqueVertices[kNumVertices * vertex::kMaxVertexSize];
+    uint32_t indices[kNumVertices];
+    float weldedACMR = 0.0F;
+    size_t numUnique = indexVertices(
+        packedVertices, kNumVertices, vertexSize, indices, uniqueVertices, weldedACMR);
+    sMeshBatch.addMesh(uniqueVertices, numUnique, indices, kNumVertices, sBoxMesh);
+
+    size_t numTubeVertices = kNumVertices - kTubeFirstVertex;
+    numUnique = indexVertices(
+        packedVertices + kTubeFirstVertex * vertexSize,
+        numTubeVertices,
+        vertexSize,
+        indices,
+        uniqueVertices,
+        weldedACMR);
+    sMeshBatch.addMesh(uniqueVertices, numUnique, indices, numTubeVertices, sTubeMesh);
+
+    printf(
+        "Batched %zu meshes: box of %u vertices, tube of %u vertices.\n",
+        sMeshBatch.numMeshes(),
+        sBoxMesh.numVertices,
+        sTubeMesh.numVertices);
+    return true;
+}
+
+/**
+ * Generate and initialize OpenGL buffer objects. The planar vertex data is encoded into interleaved
+ * vertices of `sVertexFormat`, whose attribute layout is recorded once in the vertex array object,
+ * which is all `render` has to bind. The duplicate vertices are then welded into an index buffer,
+ * whose triangles are reordered for the post-transform cache, and the vertices for the fetch. In
+ * the multi-draw mode, the meshes go to `sMeshBatch` instead.
+ */
+bool initBuffers() {
+    const float* positions = kInitialVertexData;
+    const float* colors = kInitialVertexData + kColorDataOffset;
+    float scale = vertex::positionScale(sVertexFormat.position, positions, kNumVertices);
+    uint8_t packedVertices[kNumVertices * vertex::kMaxVertexSize];
+    vertex::packVertices(sVertexFormat, positions, colors, kNumVertices, scale, packedVertices);
+    glProgramUniform1f(sGLProgram, kPositionScaleLoc, scale);
+
+    size_t vertexSize = vertex::vertexSize(sVertexFormat);
+    vertex::describeFormat(
+        sVertexFormat, kInPosLoc, kInColLoc, kVertexBindingIdx, sVertexAttribs, sVertexBindings[0]);
+    printf(
+        "Vertex format: %s positions, %s colors, %zu bytes per vertex (%zu unquantized).\n",
+        vertex::positionFormatName(sVertexFormat.position),
+        vertex::colorFormatName(sVertexFormat.color),
+        vertexSize,
+        vertex::vertexSize(vertex::kUnquantizedFormat));
+    if (sDrawMode == DrawMode::MULTI_DRAW) {
+        return initMeshBatch(packedVertices, vertexSize);
+    }
+
+    uint8_t uniqueVertices[kNumVertices * vertex::kMaxVertexSize];
+    uint32_t indices[kNumVertices];
+    float weldedACMR = 0.0F;
+    size_t numUnique = indexVertices(
+        packedVertices, kNumVertices, vertexSize, indices, uniqueVertices, weldedACMR);
 
-    glDeleteShader(shaders[0]);
-    glDeleteShader(shaders[1]);
+    glGenBuffers(1, &sVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        static_cast<GLsizeiptr>(numUnique * vertexSize),
+        uniqueVertices,
+        GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    sVAO = vertex::createVertexArray(kVertexLayout);
+    vertex::bindVertexBuffer(kVertexLayout, kVertexBindingIdx, sVBO, 0);
+
+    // The index buffer binding is recorded by the vertex array object.
+    glGenBuffers(1, &sIBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sIBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    sGLState.invalidate();
+
+    // Drawn unindexed, the triangle list reads its vertices in order.
+    uint32_t sequentialIndices[kNumVertices];
+    for (size_t idx = 0; idx < kNumVertices; idx++) {
+        sequentialIndices[idx] = static_cast<uint32_t>(idx);
+    }
+    printf(
+        "Indexed %zu vertices into %zu unique ones, ACMR: %.3f unindexed, %.3f welded, %.3f "
+        "optimized.\n",
+        kNumVertices,
+        numUnique,
+        static_cast<double>(mesh::computeACMR(sequentialIndices, kNumVertices)),
+        static_cast<double>(weldedACMR),
+        static_cast<double>(mesh::computeACMR(indices, kNumVertices)));
     return true;
 }
 
-/** Initialize uniform input variables of the OpenGL program. */
-bool initUniforms() {
-    // Inefficient, but doesn't really matter in this case...
-    if (!(utils::findAttribLocation(sGLProgram, sInPosLoc, "inPos", false) &&
-          utils::findAttribLocation(sGLProgram, sInColLoc, "inCol", false) &&
-          utils::findAttribLocation(sGLProgram, sPerspectiveMatLoc, "perspectiveMat", true) &&
-          utils::findAttribLocation(sGLProgram, sCameraOffsetLoc, "cameraOffset", true))) {
-        fprintf(stderr, "Unable to find attribute location.\n");
+/** Computes the bounds of the original box, from which those of each instance are derived. */
+void computeBoxBounds(float boxMin[3], float boxMax[3]) {
+    for (size_t axis = 0; axis < 3; axis++) {
+        boxMin[axis] = kInitialVertexData[axis];
+        boxMax[axis] = kInitialVertexData[axis];
+    }
+    for (size_t vtx = 1; vtx < kNumVertices; vtx++) {
+        const float* pos = kInitialVertexData + kPositionDataPerVertex * vtx;
+        for (size_t axis = 0; axis < 3; axis++) {
+            boxMin[axis] = fminf(boxMin[axis], pos[axis]);
+            boxMax[axis] = fmaxf(boxMax[axis], pos[axis]);
+        }
+    }
+}
+
+/** Extracts `sFrustum` from the projection and the camera offset, as applied by the shaders. */
+void updateFrustum() {
+    linalg::Mat4 perspective;
+    memcpy(perspective.m, sPerspectiveMat, sizeof(perspective.m));
+    linalg::Vec3 offset = {kCameraOffset[0], kCameraOffset[1], 0.0F};
+    sFrustum = culling::extractFrustum(perspective * linalg::translation(offset));
+}
+
+/** Creates the buffers written by `sCullProgram`, and uploads the bounds of the original box. */
+void initGpuCulling() {
+    float boxMin[3];
+    float boxMax[3];
+    computeBoxBounds(boxMin, boxMax);
+    glProgramUniform3fv(sCullProgram, kCullBoxMinLoc, 1, boxMin);
+    glProgramUniform3fv(sCullProgram, kCullBoxMaxLoc, 1, boxMax);
+    glProgramUniform1ui(sCullProgram, kCullNumInstancesLoc, static_cast<GLuint>(sNumBoxes));
+
+    glGenBuffers(1, &sVisibleInstanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, sVisibleInstanceBuffer);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        static_cast<GLsizeiptr>(sNumBoxes * sizeof(BoxInstance)),
+        nullptr,
+        GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The instance count is reset every frame, before the culling shader counts the visible ones.
+    batch::DrawElementsIndirectCommand command = {kNumVertices, 0, 0, 0, 0};
+    glGenBuffers(1, &sCullCommandBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, sCullCommandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), &command, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/** Fills `sBoxBounds` with the bounds of every instance, transformed as in the vertex shader. */
+bool initCpuCulling() {
+    if (!sBoxBounds.init(sNumBoxes)) {
         return false;
     }
 
-    glUseProgram(sGLProgram);
-    glUniformMatrix4fv(static_cast<GLint>(sPerspectiveMatLoc), 1, GL_FALSE, sPerspectiveMat);
-    glUniform2fv(static_cast<GLint>(sCameraOffsetLoc), 1, kCameraOffset);
-    glUseProgram(0);
+    float boxMin[3];
+    float boxMax[3];
+    computeBoxBounds(boxMin, boxMax);
+    const linalg::Vec3 boxCenter = {0.0F, 0.0F, -2.0F};
+    linalg::Vec3 localCenter = {
+        0.5F * (boxMin[0] + boxMax[0]),
+        0.5F * (boxMin[1] + boxMax[1]),
+        0.5F * (boxMin[2] + boxMax[2]),
+    };
+    linalg::Vec3 localExtent = {
+        0.5F * (boxMax[0] - boxMin[0]),
+        0.5F * (boxMax[1] - boxMin[1]),
+        0.5F * (boxMax[2] - boxMin[2]),
+    };
+    for (size_t idx = 0; idx < sNumBoxes; idx++) {
+        const BoxInstance& instance = sInstances[idx];
+        linalg::Vec3 offset = {instance.offset[0], instance.offset[1], instance.offset[2]};
+        linalg::Vec3 center = boxCenter + (localCenter - boxCenter) * instance.scale + offset;
+        sBoxBounds.addBox(center, localExtent * instance.scale);
+    }
+    updateFrustum();
 
+    printf(
+        "Culling on %zu threads with the %s kernel.\n",
+        sJobSystem->numThreads(),
+        culling::kernelName(culling::bestKernel()));
     return true;
 }
 
-/** Generate and initialize OpenGL buffer objects. */
-void initBuffers() {
-    glGenVertexArrays(1, &sVAO);
-    glBindVertexArray(sVAO);
+/** Mesh of a box in the multi-draw mode, alternating between the box and the tube. */
+const batch::MeshRange& boxMesh(size_t idx) {
+    return idx % 2 == 0 ? sBoxMesh : sTubeMesh;
+}
 
-    glGenBuffers(1, &sVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glBufferData(GL_ARRAY_BUFFER, kVertexDataSize, kInitialVertexData, GL_STATIC_DRAW);
+/**
+ * Lays out `sNumBoxes` boxes over a square grid centered on the original box, each with its own
+ * tint, and spread over `sGridDepth` along the view direction. A single box is left as the original
+ * one. The boxes are uploaded to `sInstanceBuffer`, attached to `sVAO`, or become the draws of
+ * `sMeshBatch` in the multi-draw mode.
+ */
+bool initInstances() {
+    size_t arenaSize = sNumBoxes * (sizeof(BoxInstance) + sizeof(uint32_t) + sizeof(float) +
+                                    sizeof(BoxDrawData) + 2 * sizeof(sorting::DrawItem));
+    if (!sInstanceArena.init(arenaSize + 6 * memory::kDefaultAlignment)) {
+        return false;
+    }
+    BoxInstance* instances = sInstanceArena.allocArray<BoxInstance>(sNumBoxes);
+    sInstances = instances;
+    sVisibleIndices = sInstanceArena.allocArray<uint32_t>(sNumBoxes);
+    sBoxDepths = sInstanceArena.allocArray<float>(sNumBoxes);
+    sBoxDrawData = sInstanceArena.allocArray<BoxDrawData>(sNumBoxes);
+    sDrawItems = sInstanceArena.allocArray<sorting::DrawItem>(sNumBoxes);
+    sDrawScratch = sInstanceArena.allocArray<sorting::DrawItem>(sNumBoxes);
+
+    size_t side = static_cast<size_t>(ceil(sqrt(static_cast<double>(sNumBoxes))));
+    float cellSize = sBoxGridExtent / static_cast<float>(side);
+    for (size_t idx = 0; idx < sNumBoxes; idx++) {
+        size_t row = idx / side;
+        size_t col = idx % side;
+        // Cheap hash of the index, so that neighbouring boxes are told apart.
+        uint32_t hash = static_cast<uint32_t>(idx) * 2654435761U;
+        float depthOffset = static_cast<float>((hash >> 8) & 0xFFFF) / 65535.0F - 0.5F;
+
+        float offset[3] = {
+            (static_cast<float>(col) + 0.5F) * cellSize - 0.5F * sBoxGridExtent,
+            (static_cast<float>(row) + 0.5F) * cellSize - 0.5F * sBoxGridExtent,
+            depthOffset * sGridDepth,
+        };
+        if (sNumBoxes == 1) {
+            offset[0] = 0.0F;
+            offset[1] = 0.0F;
+            offset[2] = 0.0F;
+        }
+        float scale = 1.0F / static_cast<float>(side);
+        // The camera looks down -z, from the origin, at the boxes scaled around `z = -2`.
+        sBoxDepths[idx] = 2.0F - offset[2];
+        float shade = 0.5F + 0.5F * static_cast<float>(hash >> 24) / 255.0F;
+        float tint[3] = {shade, 1.5F - shade, 1.0F};
+        if (sNumBoxes == 1) {
+            tint[0] = 1.0F;
+            tint[1] = 1.0F;
+        }
+
+        if (sDrawMode == DrawMode::MULTI_DRAW) {
+            sBoxDrawData[idx] = {
+                {offset[0], offset[1], offset[2], scale},
+                {tint[0], tint[1], tint[2], 1.0F},
+            };
+            sMeshBatch.addDraw(boxMesh(idx), &sBoxDrawData[idx]);
+        } else {
+            BoxInstance& instance = instances[idx];
+            instance.offset[0] = offset[0];
+            instance.offset[1] = offset[1];
+            instance.offset[2] = offset[2];
+            instance.scale = scale;
+            instance.tint = vertex::packRGBA8(tint[0], tint[1], tint[2], 1.0F);
+        }
+    }
+
+    if (sDrawMode != DrawMode::MULTI_DRAW) {
+        glGenBuffers(1, &sInstanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, sInstanceBuffer);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(sNumBoxes * sizeof(BoxInstance)),
+            instances,
+            GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (sCullMode == CullMode::GPU) {
+            initGpuCulling();
+        } else if (sCullMode == CullMode::CPU && !initCpuCulling()) {
+            return false;
+        }
+        bool streamed = sDrawMode == DrawMode::INSTANCED &&
+                        (sCullMode == CullMode::CPU || sSortDraws);
+        if (streamed &&
+            !sVisibleInstanceStream.init(GL_ARRAY_BUFFER, sNumBoxes * sizeof(BoxInstance))) {
+            return false;
+        }
+
+        // With GPU culling, only the visible instances compacted by `sCullProgram` are drawn. The
+        // CPU culling and the sorting bind the stream buffer region written each frame instead.
+        GLuint drawnInstances =
+            sCullMode == CullMode::GPU ? sVisibleInstanceBuffer : sInstanceBuffer;
+        glBindVertexArray(sVAO);
+        vertex::bindVertexBuffer(kVertexLayout, kInstanceBindingIdx, drawnInstances, 0);
+        glBindVertexArray(0);
+        sGLState.invalidate();
+    }
+
+    const char* modeStr = "a single instanced draw call";
+    if (sDrawMode == DrawMode::PER_BOX) {
+        modeStr = "a draw call per box";
+    } else if (sDrawMode == DrawMode::MULTI_DRAW) {
+        modeStr = "a single multi-draw indirect call";
+    }
+    printf(
+        "Drawing %zu boxes with %s%s%s.\n",
+        sNumBoxes,
+        modeStr,
+        sCullMode == CullMode::GPU   ? ", culled on the GPU"
+        : sCullMode == CullMode::CPU ? ", culled on the CPU"
+                                     : "",
+        sSortDraws ? ", sorted front-to-back" : "");
+    return true;
+}
+
+/**
+ * Instanced draw of the boxes visible from the camera. The culling shader compacts the visible
+ * instances and counts them in the indirect command, which the draw reads directly, so culling
+ * takes neither a readback nor any work per box on the CPU.
+ */
+void renderGpuCulled() {
+    static const GLuint kZero = 0;
+    sGLState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, sCullCommandBuffer);
+    glClearBufferSubData(
+        GL_DRAW_INDIRECT_BUFFER,
+        GL_R32UI,
+        offsetof(batch::DrawElementsIndirectCommand, instanceCount),
+        sizeof(GLuint),
+        GL_RED_INTEGER,
+        GL_UNSIGNED_INT,
+        &kZero);
+
+    sGLState.useProgram(sCullProgram);
+    sGLState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, kCullInstancesBinding, sInstanceBuffer);
+    sGLState.bindBufferBase(
+        GL_SHADER_STORAGE_BUFFER, kCullVisibleBinding, sVisibleInstanceBuffer);
+    sGLState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, kCullCommandBinding, sCullCommandBuffer);
+    GLuint numWorkGroups =
+        (static_cast<GLuint>(sNumBoxes) + kCullWorkGroupSize - 1) / kCullWorkGroupSize;
+    sGpuProfiler.beginScope("cull");
+    glDispatchCompute(numWorkGroups, 1, 1);
+    sGpuProfiler.endScope();
+
+    // The draw must see both the instance count and the compacted instances.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+    sGLState.useProgram(sGLProgram);
+    sGLState.bindVertexArray(sVAO);
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr);
+}
+
+/**
+ * Sorts the boxes of `sVisibleIndices` by program, mesh and then front-to-back, so that the nearest
+ * boxes fill the depth buffer before the ones they hide are drawn.
+ */
+void sortBoxes(size_t numBoxes) {
+    TRACE_FUNCTION();
+    for (size_t idx = 0; idx < numBoxes; idx++) {
+        uint32_t box = sVisibleIndices[idx];
+        uint32_t material = sDrawMode == DrawMode::MULTI_DRAW ? box % 2 : 0;
+        sDrawItems[idx].key =
+            sorting::makeKey(sGLProgram, material, sBoxDepths[box], kZCameraNear, kZCameraFar);
+        sDrawItems[idx].index = box;
+    }
+    sorting::sortDraws(sDrawItems, sDrawScratch, numBoxes);
+    for (size_t idx = 0; idx < numBoxes; idx++) {
+        sVisibleIndices[idx] = sDrawItems[idx].index;
+    }
+}
+
+/**
+ * Writes the boxes drawn in the frame to `sVisibleIndices`, in draw order: the visible ones with
+ * the CPU culling, every box otherwise, sorted with `--sort`.
+ *
+ * @return Number of boxes drawn.
+ */
+size_t orderBoxes() {
+    TRACE_FUNCTION();
+    sFrameStats.beginUpdate();
+    size_t numDrawn = sNumBoxes;
+    if (sCullMode == CullMode::CPU) {
+        numDrawn = culling::cull(
+            sFrustum,
+            sBoxBounds,
+            culling::Volume::BOX,
+            sVisibleIndices,
+            sJobSystem,
+            culling::bestKernel());
+        sNumVisible = numDrawn;
+    } else {
+        for (size_t idx = 0; idx < sNumBoxes; idx++) {
+            sVisibleIndices[idx] = static_cast<uint32_t>(idx);
+        }
+    }
+    if (sSortDraws) {
+        sortBoxes(numDrawn);
+    }
+    sFrameStats.endUpdate();
+    return numDrawn;
+}
+
+/**
+ * Instanced draw of the boxes ordered by `orderBoxes`. Their instances are copied to the current
+ * region of the stream buffer, from which the instance binding fetches them.
+ */
+void renderStreamed() {
+    size_t numDrawn = orderBoxes();
+    BoxInstance* drawnInstances = static_cast<BoxInstance*>(sVisibleInstanceStream.beginRegion());
+    for (size_t idx = 0; idx < numDrawn; idx++) {
+        drawnInstances[idx] = sInstances[sVisibleIndices[idx]];
+    }
+
+    sGLState.bindVertexArray(sVAO);
+    vertex::bindVertexBuffer(
+        kVertexLayout,
+        kInstanceBindingIdx,
+        sVisibleInstanceStream.buffer(),
+        sVisibleInstanceStream.regionOffset());
+    glDrawElementsInstanced(
+        GL_TRIANGLES, kNumVertices, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(numDrawn));
+    sVisibleInstanceStream.endRegion();
+}
+
+/**
+ * Writes the camera of the frame to the uniform ring, bound once for every program reading the
+ * `Camera` block.
+ */
+void uploadCamera() {
+    uniforms::Allocation allocation;
+    if (!sUniformRing.allocate(sizeof(CameraBlock), allocation)) {
+        return;
+    }
+    CameraBlock camera = {};
+    memcpy(camera.perspectiveMat, sPerspectiveMat, sizeof(camera.perspectiveMat));
+    memcpy(camera.cameraOffset, kCameraOffset, sizeof(camera.cameraOffset));
+    // Written as a whole, the mapped memory is never read.
+    memcpy(allocation.data, &camera, sizeof(camera));
+    sUniformRing.bind(sGLState, kCameraBinding, allocation);
 }
 
 /** Render to backbuffer */
 void render() {
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(sGLProgram);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-
-    glEnableVertexAttribArray(sInPosLoc);
-    glEnableVertexAttribArray(sInColLoc);
-    glVertexAttribPointer(sInPosLoc, kPositionDataPerVertex, GL_FLOAT, GL_FALSE, 0, 0);
-    glVertexAttribPointer(
-        sInColLoc,
-        kColorDataPerVertex,
-        GL_FLOAT,
-        GL_FALSE,
-        0,
-        reinterpret_cast<GLvoid*>(kColorDataOffset));
-
-    glDrawArrays(GL_TRIANGLES, 0, kNumVertices);
-
-    glDisableVertexAttribArray(sInColLoc);
-    glDisableVertexAttribArray(sInPosLoc);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glUseProgram(0);
+    TRACE_FUNCTION();
+    sGpuProfiler.beginFrame();
+    sGpuProfiler.beginScope("frame");
+    sUniformRing.beginFrame();
+    uploadCamera();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    sGLState.useProgram(sGLProgram);
+
+    switch (sDrawMode) {
+        case DrawMode::INSTANCED: {
+            if (sCullMode == CullMode::GPU) {
+                renderGpuCulled();
+                break;
+            }
+            if (sCullMode == CullMode::CPU || sSortDraws) {
+                renderStreamed();
+                break;
+            }
+            sGLState.bindVertexArray(sVAO);
+            glDrawElementsInstanced(
+                GL_TRIANGLES,
+                kNumVertices,
+                GL_UNSIGNED_INT,
+                nullptr,
+                static_cast<GLsizei>(sNumBoxes));
+        } break;
+        case DrawMode::PER_BOX: {
+            // The base instance selects the box, in sorted order with `--sort`.
+            if (sSortDraws) {
+                orderBoxes();
+            }
+            sGLState.bindVertexArray(sVAO);
+            for (size_t idx = 0; idx < sNumBoxes; idx++) {
+                glDrawElementsInstancedBaseInstance(
+                    GL_TRIANGLES,
+                    kNumVertices,
+                    GL_UNSIGNED_INT,
+                    nullptr,
+                    1,
+                    sSortDraws ? sVisibleIndices[idx] : static_cast<GLuint>(idx));
+            }
+        } break;
+        case DrawMode::MULTI_DRAW: {
+            // The draws are rebuilt in sorted order, grouped by mesh.
+            if (sSortDraws) {
+                orderBoxes();
+                sMeshBatch.clearDraws();
+                for (size_t idx = 0; idx < sNumBoxes; idx++) {
+                    uint32_t box = sVisibleIndices[idx];
+                    sMeshBatch.addDraw(boxMesh(box), &sBoxDrawData[box]);
+                }
+            }
+            sMeshBatch.draw(sGLState, kDrawDataBinding);
+        } break;
+    }
+    sGpuProfiler.endScope();
+    sUniformRing.endFrame();
+    sGLState.endFrame();
+    sGpuProfiler.endFrame();
 }
 
 /** Delete OpenGL objects. */
@@ -271,47 +1085,265 @@ void terminateRenderer() {
     fprintf(stderr, "Terminating renderer...\n");
     glDeleteVertexArrays(1, &sVAO);
     glDeleteBuffers(1, &sVBO);
+    glDeleteBuffers(1, &sIBO);
+    glDeleteBuffers(1, &sInstanceBuffer);
+    glDeleteBuffers(1, &sVisibleInstanceBuffer);
+    glDeleteBuffers(1, &sCullCommandBuffer);
+    glDeleteProgram(sCullProgram);
+    sVisibleInstanceStream.destroy();
+    sUniformRing.destroy();
+    sMeshBatch.destroy();
+    sGpuProfiler.destroy();
     glDeleteProgram(sGLProgram);
 }
 
+/**
+ * Reads the fragment counts of the frame back from the red channel, see `--overdraw`.
+ *
+ * @return Average number of fragments shaded per covered pixel, or 0 if none is covered.
+ */
+double measureOverdraw() {
+    int width = 0;
+    int height = 0;
+    sDisplay.framebufferSize(width, height);
+    size_t numPixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    if (sOverdrawArena.capacity() < numPixels && !sOverdrawArena.init(numPixels)) {
+        return 0.0;
+    }
+    sOverdrawArena.reset();
+    uint8_t* counts = sOverdrawArena.allocArray<uint8_t>(numPixels);
+    if (!counts) {
+        return 0.0;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, counts);
+    // Back to the default alignment, which the other readbacks expect.
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    size_t numFragments = 0;
+    size_t numCovered = 0;
+    for (size_t idx = 0; idx < numPixels; idx++) {
+        numFragments += counts[idx];
+        numCovered += counts[idx] != 0 ? 1 : 0;
+    }
+    return numCovered > 0 ? static_cast<double>(numFragments) / static_cast<double>(numCovered)
+                          : 0.0;
+}
+
 /** Resize window respecting the aspect ratio. */
 void resizeCallback(GLFWwindow* window, int width, int height) {
+    // The programs pick the new projection up with the camera of the next frame.
     sPerspectiveMat[0] = kFrustumScale * static_cast<float>(height) / static_cast<float>(width);
-    glUseProgram(sGLProgram);
-    glUniformMatrix4fv(static_cast<GLint>(sPerspectiveMatLoc), 1, GL_FALSE, sPerspectiveMat);
-    glUseProgram(0);
+    updateFrustum();
     glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
 }
 
-int main() {
-    GLFWwindow* window = utils::initGLFW("Rectangle 3D");
-    utils::setGLFWCallbacks(window, utils::KEY_CALLBACK | utils::WINDOW_CLOSE_CALLBACK);
-    glfwSetWindowSizeCallback(window, resizeCallback);
+int main(int argc, char** argv) {
+    bench::Options benchOptions;
+    display::Options displayOptions;
+    if (!bench::parseOptions(argc, argv, benchOptions) ||
+        !display::parseOptions(argc, argv, displayOptions)) {
+        return -1;
+    }
+    const char* tracePath = utils::findArgValue(argc, argv, "--trace");
+    if (tracePath) {
+        tracing::start();
+        tracing::setThreadName("main");
+    }
+    sNumBoxes = utils::parseArgSize(argc, argv, "--boxes", 1);
+    if (sNumBoxes == 0) {
+        fprintf(stderr, "The scene requires at least one box.\n");
+        return -1;
+    }
+    if (utils::hasArg(argc, argv, "--draw-per-box")) {
+        sDrawMode = DrawMode::PER_BOX;
+    } else if (utils::hasArg(argc, argv, "--multi-draw")) {
+        sDrawMode = DrawMode::MULTI_DRAW;
+    }
+    if (utils::hasArg(argc, argv, "--gpu-cull")) {
+        sCullMode = CullMode::GPU;
+    } else if (utils::hasArg(argc, argv, "--cpu-cull")) {
+        sCullMode = CullMode::CPU;
+    }
+    if (sCullMode != CullMode::NONE && sDrawMode != DrawMode::INSTANCED) {
+        fprintf(stderr, "Culling is only available with the instanced draw.\n");
+        return -1;
+    }
+    const char* gridExtentStr = utils::findArgValue(argc, argv, "--grid-extent");
+    if (gridExtentStr) {
+        sBoxGridExtent = strtof(gridExtentStr, nullptr);
+        if (!(sBoxGridExtent > 0.0F)) {
+            fprintf(
+                stderr, "Invalid grid extent '%s', expected a positive number.\n", gridExtentStr);
+            return -1;
+        }
+    }
+    const char* gridDepthStr = utils::findArgValue(argc, argv, "--grid-depth");
+    if (gridDepthStr) {
+        sGridDepth = strtof(gridDepthStr, nullptr);
+        if (!(sGridDepth >= 0.0F)) {
+            fprintf(
+                stderr,
+                "Invalid grid depth '%s', expected a non-negative number.\n",
+                gridDepthStr);
+            return -1;
+        }
+    }
+    sSortDraws = utils::hasArg(argc, argv, "--sort");
+    if (sSortDraws && sCullMode == CullMode::GPU) {
+        fprintf(stderr, "Sorting the draws isn't available with the GPU culling.\n");
+        return -1;
+    }
+    sOverdraw = utils::hasArg(argc, argv, "--overdraw");
+    const char* positionFormatStr = utils::findArgValue(argc, argv, "--position-format");
+    if (positionFormatStr &&
+        !vertex::parsePositionFormat(positionFormatStr, sVertexFormat.position)) {
+        fprintf(
+            stderr,
+            "Unknown position format '%s', expected 'float', 'half' or 'snorm16'.\n",
+            positionFormatStr);
+        return -1;
+    }
+    const char* colorFormatStr = utils::findArgValue(argc, argv, "--color-format");
+    if (colorFormatStr && !vertex::parseColorFormat(colorFormatStr, sVertexFormat.color)) {
+        fprintf(
+            stderr,
+            "Unknown color format '%s', expected 'float', 'rgba8' or 'rgb10a2'.\n",
+            colorFormatStr);
+        return -1;
+    }
+
+    // Only the CPU culling uses worker threads, a single thread spawns none.
+    size_t numThreads =
+        sCullMode == CullMode::CPU
+            ? utils::parseArgSize(argc, argv, "--threads", 0, jobs::JobSystem::maxThreads())
+            : 1;
+    jobs::JobSystem jobSystem(numThreads);
+    sJobSystem = &jobSystem;
 
-    glEnable(GL_CULL_FACE);
+    if (!sDisplay.init("Rectangle 3D", displayOptions)) {
+        return -1;
+    }
+    if (sDisplay.window()) {
+        // Closing the window only ends the loop, the window and its context are torn down by
+        // `sDisplay.destroy`, once the last results are read back.
+        utils::setGLFWCallbacks(sDisplay.window(), utils::KEY_CALLBACK);
+        glfwSetWindowSizeCallback(sDisplay.window(), resizeCallback);
+    }
+    if (benchOptions.numFrames > 0) {
+        sDisplay.setSwapInterval(0);
+    }
+
+    sGLState.enable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CW);
+    sGLState.enable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    if (sOverdraw) {
+        // Every fragment passing the depth test adds its step to the pixel.
+        sGLState.enable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+    }
 
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(utils::errorCallbackGL, nullptr);
 
+    if (!utils::hasArg(argc, argv, "--no-shader-cache")) {
+        const char* cacheDir = utils::findArgValue(argc, argv, "--shader-cache");
+        sProgramCache.init(cacheDir ? cacheDir : shaders::kDefaultCacheDirectory);
+    }
     if (!initProgram()) {
         fprintf(stderr, "Unable to initialize the program.\n");
-        utils::windowCloseCallbackGLFW(window);
-        glfwTerminate();
+        sDisplay.destroy();
+        return -1;
+    }
+    if (!(sUniformRing.init() && initBuffers() && initInstances())) {
+        terminateRenderer();
+        sDisplay.destroy();
         return -1;
     }
-    initUniforms();
-    initBuffers();
+    if (sOverdraw) {
+        glProgramUniform1f(sGLProgram, kOverdrawStepLoc, kOverdrawStep);
+        int width = 0;
+        int height = 0;
+        sDisplay.framebufferSize(width, height);
+        if (!sOverdrawArena.init(static_cast<size_t>(width) * static_cast<size_t>(height))) {
+            terminateRenderer();
+            sDisplay.destroy();
+            return -1;
+        }
+    }
 
     glClearColor(0.0, 0.0, 0.0, 1.0);
-    while (!glfwWindowShouldClose(window)) {
+    sFrameStats.init(std::max(telemetry::kDefaultCapacity, benchOptions.numFrames));
+    sGpuProfiler.init();
+    double overdraw = 0.0;
+    double lastOverdrawTime = 0.0;
+    double startTime = sDisplay.time();
+    size_t frameIdx = 0;
+    while (!sDisplay.shouldClose() &&
+           (benchOptions.numFrames == 0 || frameIdx < benchOptions.numFrames)) {
+        sFrameStats.beginFrame();
         render();
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // The counts are read from the back buffer, before it is presented, once per second.
+        if (sOverdraw && sDisplay.time() - lastOverdrawTime > 1.0) {
+            lastOverdrawTime = sDisplay.time();
+            overdraw = measureOverdraw();
+        }
+        sFrameStats.beginSwap();
+        sDisplay.swapBuffers();
+        sFrameStats.endSwap();
+        sDisplay.pollEvents();
+        sFrameStats.endFrame();
+        frameIdx++;
+
+        size_t numFrames = 0;
+        telemetry::Summary summary = {};
+        if (sFrameStats.reportDue(1.0, numFrames) && sFrameStats.summarize(numFrames, summary)) {
+            char summaryStr[128];
+            char gpuStr[128];
+            telemetry::formatSummary(summary, summaryStr, sizeof(summaryStr));
+            sGpuProfiler.format(gpuStr, sizeof(gpuStr));
+            printf("\r\x1b[A\x1b[2K");
+            printf("FPS: %.0f, %s, %s", summary.fps, summaryStr, gpuStr);
+            if (sOverdraw) {
+                printf(", %.2f fragments per covered pixel", overdraw);
+            }
+            printf("\n");
+        }
+    }
+    if (benchOptions.numFrames > 0) {
+        // The scene is static, there is no simulation to check.
+        glFinish();
+        bench::Report report = {
+            "rectangle3D",
+            frameIdx,
+            sDisplay.time() - startTime,
+            sNumBoxes * kNumVertices,
+            0,
+            0,
+            "none",
+        };
+        bench::printReport(report, sFrameStats);
+    }
+    telemetry::reportAtExit(sFrameStats, utils::findArgValue(argc, argv, "--frame-stats"));
+    if (tracePath) {
+        tracing::writeChromeTrace(tracePath);
+    }
+    printf(
+        "GL state changes in the last frame: %zu issued, %zu skipped.\n",
+        sGLState.lastFrame().issued,
+        sGLState.lastFrame().skipped);
+    if (sCullMode == CullMode::GPU) {
+        // Read without binding, so that the bindings shadowed by `sGLState` stay in sync.
+        batch::DrawElementsIndirectCommand command = {};
+        glGetNamedBufferSubData(sCullCommandBuffer, 0, sizeof(command), &command);
+        printf("Boxes visible in the last frame: %u of %zu.\n", command.instanceCount, sNumBoxes);
+    } else if (sCullMode == CullMode::CPU) {
+        printf("Boxes visible in the last frame: %zu of %zu.\n", sNumVisible, sNumBoxes);
     }
     terminateRenderer();
-    glfwTerminate();
+    sDisplay.destroy();
 
     return 0;
 }
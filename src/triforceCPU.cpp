@@ -1,37 +1,44 @@
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
-#include <math.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <algorithm>
+#include <chrono>
 
+#include "base/arena.h"
+#include "base/benchmark.h"
+#include "base/display.h"
+#include "base/frameStats.h"
+#include "base/glState.h"
+#include "base/gpuProfiler.h"
+#include "base/jobs.h"
+#include "base/programCache.h"
+#include "base/rotation.h"
+#include "base/streamBuffer.h"
+#include "base/trace.h"
+#include "base/triforce.h"
 #include "base/utils.h"
+#include "base/vertexLayout.h"
 
-// Angle variation per frame for each axis.
+// Angle variation per simulation step for each axis.
 constexpr static const float kDeltaAngle = 2.0F * PI / 100.0F;
 
 // Number of entries that represent a single vertex.
 static const size_t kDataPerVertex = 4;
+
+// Number of triforces tiled over the scene, selected at startup with `--instances=N`.
+static size_t sNumInstances = 1;
+
 // Total number of vertices present in the vertex buffer object.
-static const size_t kNumVertices = 9;
-// Triangle vertex positions in 4D clip-space. Each 4 entries represent a
-// single.
-static float sVboData[kNumVertices * kDataPerVertex] = {
-    // clang-format off
-    // Upper triangle
-    0.0, 0.5, 0.0, 1.0,
-    -0.25, 0.0, 0.0, 1.0,
-    0.25, 0.0, 0.0, 1.0,
-    // Down left triangle
-    -0.25, 0.0, 0.0, 1.0,
-    -0.5, -0.5, 0.0, 1.0,
-    0.0, -0.5, 0.0, 1.0,
-    // Down right triangle
-    0.25, 0.0, 0.0, 1.0,
-    0.0, -0.5, 0.0, 1.0,
-    0.5, -0.5, 0.0, 1.0
-    // clang-format on
-};
+static size_t sNumVertices = triforce::kVerticesPerInstance;
+
+// Arena holding the CPU-side vertex data.
+static memory::Arena sArena;
+
+// Triangle vertex positions in 4D clip-space, allocated from `sArena`. Each 4 entries represent a
+// single vertex.
+static float *sVboData = nullptr;
 
 /** @brief String representing the vertex shader. */
 static const char *kVertexShaderStr =
@@ -56,153 +63,400 @@ void main() {
 /** @brief OpenGL program containing the vertex and fragment shader. */
 static GLuint sGLProgram = 0;
 
-/** @brief Vertex buffer object. */
-static GLuint sVBO = 0;
+/** @brief On-disk cache of the linked programs, see `--shader-cache` and `--no-shader-cache`. */
+static shaders::ProgramCache sProgramCache;
 
-/** @brief Vertex array object. */
-static GLuint sVAO = 0;
+/**
+ * @brief Persistently mapped vertex buffer, the rotated vertices are written directly into its
+ *        current region every frame.
+ */
+static stream::StreamBuffer sVertexStream;
+
+/** @brief Layout of the vertices: tightly packed positions fetched from binding 0. */
+static const vertex::Attrib kVertexAttribs[1] = {{0, kDataPerVertex, GL_FLOAT, GL_FALSE, 0, 0}};
+static const vertex::Binding kVertexBindings[1] = {{0, kDataPerVertex * sizeof(float), 0}};
+static const vertex::Layout kVertexLayout = {kVertexAttribs, 1, kVertexBindings, 1};
 
 /**
- * @brief Initializes the OpenGL program object `sGLProgram` by creating the
- *        shaders from `kVertexShaderStr` and `kFragmentShaderStr`. If the creation
- *        of the program fails, the function will toggle the GLFW window to close.
- *
- * @param window Window associated to the OpenGL context.
+ * @brief Vertex array objects, one per region of `sVertexStream`, each fetching the vertices from
+ *        its region. Drawing a region only takes binding its vertex array.
+ */
+static GLuint sVAOs[stream::kMaxRegions] = {0};
+
+/** @brief Shadow of the bindings of the context, dropping the redundant ones. */
+static glstate::StateCache sGLState;
+
+// Window, or offscreen framebuffer with `--headless`, the frames are rendered to.
+static display::Display sDisplay;
+
+// Timings of the last frames, reported once per second and at exit.
+static telemetry::FrameStats sFrameStats;
+
+// GPU timings of the draw of the streamed vertices.
+static profiling::GpuProfiler sGpuProfiler;
+
+// Minimum number of vertices rotated by a single job.
+static const size_t kVerticesPerJob = 1 << 14;
+
+/** @brief Pool of threads sharing the vertex transform. */
+static jobs::JobSystem *sJobSystem = nullptr;
+
+/**
+ * @brief Initializes the OpenGL program object `sGLProgram` from `kVertexShaderStr` and
+ *        `kFragmentShaderStr`, restoring it from `sProgramCache` when possible.
  */
 bool initShaderProgram() {
-    GLuint vertexShader, fragmentShader;
-    if (!(utils::createShaderFromString(vertexShader, GL_VERTEX_SHADER, kVertexShaderStr) &&
-          utils::createShaderFromString(fragmentShader, GL_FRAGMENT_SHADER, kFragmentShaderStr))) {
+    const shaders::ShaderSource sources[2] = {
+        {GL_VERTEX_SHADER, kVertexShaderStr},
+        {GL_FRAGMENT_SHADER, kFragmentShaderStr},
+    };
+    shaders::ProgramDesc desc = {sources, 2, nullptr, 0, GL_NONE};
+    return shaders::createProgram(sGLProgram, desc, &sProgramCache);
+}
+
+/**
+ * @brief Allocates `sVboData` from `sArena` and tiles `sNumInstances` triforces over it.
+ */
+bool initSceneData() {
+    if (sNumInstances == 0) {
+        fprintf(stderr, "The scene requires at least one triforce.\n");
         return false;
     }
-    GLuint shaders[2] = {vertexShader, fragmentShader};
-
-    if (!utils::createProgram(sGLProgram, shaders, 2)) {
+    if (sNumInstances > triforce::kMaxInstances) {
+        fprintf(
+            stderr,
+            "The scene holds at most %zu triforces, %zu requested.\n",
+            triforce::kMaxInstances,
+            sNumInstances);
+        return false;
+    }
+    sNumVertices = sNumInstances * triforce::kVerticesPerInstance;
+    size_t dataSize = sNumVertices * kDataPerVertex * sizeof(float);
+    if (!sArena.init(dataSize)) {
         return false;
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    sVboData = sArena.allocArray<float>(sNumVertices * kDataPerVertex);
+    triforce::tile(sVboData, sNumInstances, kDataPerVertex);
+
+    printf("Scene: %zu triforces, %zu vertices.\n", sNumInstances, sNumVertices);
+    return true;
+}
 
+/**
+ * @brief Creates the stream buffer `sVertexStream` holding one copy of `sVboData` per region,
+ *        and the vertex array object of each region.
+ */
+bool initBufferObjects() {
+    if (!sVertexStream.init(GL_ARRAY_BUFFER, sNumVertices * kDataPerVertex * sizeof(float))) {
+        return false;
+    }
+    for (size_t idx = 0; idx < sVertexStream.numRegions(); idx++) {
+        sVAOs[idx] = vertex::createVertexArray(kVertexLayout);
+        vertex::bindVertexBuffer(
+            kVertexLayout, 0, sVertexStream.buffer(), sVertexStream.regionOffset(idx));
+    }
+    glBindVertexArray(0);
+    sGLState.invalidate();
     return true;
 }
 
 /**
- * @brief Takes the data from `sVBOData` and copies it into an OpenGL buffer
- *        `sVBO` in the GPU.
+ * @brief Rotate the vertices in `sVBOData` by the linear map given by its coefficients.
+ *
+ * @param coeffs Coefficients of the rotation, see `rotation::computeCoefficients`.
+ * @param dst Mapped GPU memory that also receives the rotated vertices.
  */
-void initBufferObjects() {
-    glGenVertexArrays(1, &sVAO);
-    glGenBuffers(1, &sVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sVboData), sVboData, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+void rotateVertices(const float *coeffs, float *dst) {
+    TRACE_FUNCTION();
+    rotation::Kernel kernel = rotation::bestKernel();
+    sJobSystem->parallelFor(0, sNumVertices, kVerticesPerJob, [&](size_t begin, size_t end) {
+        TRACE_SCOPE("rotateJob");
+        size_t offset = kDataPerVertex * begin;
+        rotation::rotateVerticesWith(
+            kernel, sVboData + offset, end - begin, coeffs, dst + offset);
+    });
 }
 
 /**
- * @brief Rotate the vertices in `sVBOData` by given a given angle in each axis x, y and z.
+ * @brief Allocates the vertices for the benchmarks from an arena, tiling triforces over them.
  *
- * @param t Common rotation angle for each axis.
+ * @param arena Arena, initialized by this function, owning the vertices.
+ * @param numVertices Minimum number of vertices in the buffer.
  */
-void rotateVertices(float t) {
-    for (size_t vertexIdx = 0; vertexIdx < kNumVertices; vertexIdx++) {
-        size_t idx = kDataPerVertex * vertexIdx;
-        float x = sVboData[idx];
-        float y = sVboData[idx + 1];
-        float z = sVboData[idx + 2];
-
-        sVboData[idx] = (2.0F * x + 2.0F * z + y * cosf(t) + 2.0F * x * cosf(2.0F * t) -
-                         2.0F * z * cosf(2.0F * t) - y * cosf(3.0F * t) + z * sinf(t) -
-                         2.0F * y * sinf(2.0F * t) + z * sinf(3.0F * t)) /
-                        4.0F;
-        sVboData[idx + 1] = (2.0F * y + z * cosf(t) + 2.0F * y * cosf(2.0F * t) -
-                             z * cosf(3.0F * t) + 3.0F * y * sinf(t) + 2.0F * x * sinf(2.0F * t) -
-                             2.0F * z * sinf(2.0F * t) - y * sinf(3.0F * t)) /
-                            4.0F;
-        sVboData[idx + 2] =
-            (z + z * cosf(2.0F * t) - 2.0F * x * sinf(t) + y * sinf(2.0F * t)) / 2.0F;
+float *allocBenchmarkVertices(memory::Arena &arena, size_t numVertices) {
+    size_t numInstances =
+        (numVertices + triforce::kVerticesPerInstance - 1) / triforce::kVerticesPerInstance;
+    size_t numFloats = numInstances * triforce::kVerticesPerInstance * kDataPerVertex;
+    if (!arena.init(numFloats * sizeof(float))) {
+        return nullptr;
     }
+    float *vertices = arena.allocArray<float>(numFloats);
+    triforce::tile(vertices, numInstances, kDataPerVertex);
+    return vertices;
 }
 
 /**
- * @brief Update vertex positions in `sVBO` and copies to the corresponding
- *        vertex buffer object.
+ * @brief Measures the throughput, in vertices per second, of the original trigonometric rotation
+ *        loop against each rotation kernel supported by the CPU. No window is created.
+ *
+ * @param numVertices Number of vertices rotated on each iteration.
  */
-void updateScene() {
-    rotateVertices(kDeltaAngle);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(sVboData), &sVboData);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+void runRotationBenchmark(size_t numVertices) {
+    const size_t kIterations = 20;
+    memory::Arena arena;
+    float *vertices = allocBenchmarkVertices(arena, numVertices);
+    if (!vertices) {
+        return;
+    }
+
+    printf("Rotating %zu vertices, %zu iterations per kernel:\n", numVertices, kIterations);
+    auto report = [&](const char *name, double seconds) {
+        double verticesPerSec = static_cast<double>(numVertices * kIterations) / seconds;
+        printf("    %-10s %10.2f Mvertices/s\n", name, verticesPerSec / 1.0e6);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < kIterations; iter++) {
+        rotation::rotateVerticesReference(vertices, numVertices, kDeltaAngle);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report("reference", elapsed.count());
+
+    const rotation::Kernel kernels[] = {
+        rotation::Kernel::SCALAR,
+        rotation::Kernel::SSE,
+        rotation::Kernel::AVX2,
+        rotation::Kernel::NEON,
+    };
+    for (rotation::Kernel kernel : kernels) {
+        if (!rotation::isKernelSupported(kernel)) {
+            continue;
+        }
+        start = std::chrono::steady_clock::now();
+        for (size_t iter = 0; iter < kIterations; iter++) {
+            float coeffs[rotation::kNumCoefficients];
+            rotation::computeCoefficients(kDeltaAngle, coeffs);
+            rotation::rotateVerticesWith(kernel, vertices, numVertices, coeffs);
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        report(rotation::kernelName(kernel), elapsed.count());
+    }
+}
+
+/**
+ * @brief Measures how the vertex transform scales with the number of threads of the job system,
+ *        from a single thread up to every hardware thread. No window is created.
+ *
+ * @param numVertices Number of vertices rotated on each iteration.
+ */
+void runThreadScalingBenchmark(size_t numVertices) {
+    const size_t kIterations = 20;
+    memory::Arena arena;
+    float *vertices = allocBenchmarkVertices(arena, numVertices);
+    if (!vertices) {
+        return;
+    }
+
+    size_t maxThreads = jobs::JobSystem::hardwareThreads();
+    rotation::Kernel kernel = rotation::bestKernel();
+    float coeffs[rotation::kNumCoefficients];
+    rotation::computeCoefficients(kDeltaAngle, coeffs);
+
+    printf(
+        "Rotating %zu vertices with the %s kernel, %zu iterations per thread count:\n",
+        numVertices,
+        rotation::kernelName(kernel),
+        kIterations);
+    printf("    threads  Mvertices/s  speedup\n");
+    double singleThreadRate = 0.0;
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads++) {
+        jobs::JobSystem jobSystem(numThreads);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t iter = 0; iter < kIterations; iter++) {
+            jobSystem.parallelFor(0, numVertices, kVerticesPerJob, [&](size_t begin, size_t end) {
+                rotation::rotateVerticesWith(
+                    kernel, vertices + kDataPerVertex * begin, end - begin, coeffs);
+            });
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double rate = static_cast<double>(numVertices * kIterations) / elapsed.count();
+        if (numThreads == 1) {
+            singleThreadRate = rate;
+        }
+        printf("    %7zu  %11.2f  %7.2f\n", numThreads, rate / 1.0e6, rate / singleThreadRate);
+    }
+}
+
+/**
+ * @brief Update vertex positions in `sVboData`, writing them straight into the next region of
+ *        `sVertexStream`. The region is written even without any step, since it holds the
+ *        vertices of an older frame.
+ *
+ * @param numSteps Number of simulation steps of the frame, each rotating by `kDeltaAngle`.
+ */
+void updateScene(size_t numSteps) {
+    TRACE_FUNCTION();
+    float coeffs[rotation::kNumCoefficients];
+    if (numSteps == 1) {
+        rotation::computeCoefficients(kDeltaAngle, coeffs);
+    } else {
+        rotation::coefficientsFromMatrix(
+            rotation::rotationMatrixSteps(kDeltaAngle, numSteps), coeffs);
+    }
+    float *region = static_cast<float *>(sVertexStream.beginRegion());
+    rotateVertices(coeffs, region);
 }
 
 /**
  * @brief Clears the display, and using the `sGLProgram` program object and the
- *        `sVBO` buffer object, draws to the back buffer.
+ *        current region of `sVertexStream`, draws to the back buffer. The region is
+ *        fenced right after the draw. The bindings are left in place for the next
+ *        frame, so that `sGLState` drops them.
  */
 void renderScene() {
+    TRACE_FUNCTION();
+    sGpuProfiler.beginFrame();
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(sGLProgram);
-    glBindVertexArray(sVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, kDataPerVertex, GL_FLOAT, GL_FALSE, 0, 0);
+    sGpuProfiler.beginScope("render");
+    sGLState.useProgram(sGLProgram);
+    sGLState.bindVertexArray(sVAOs[sVertexStream.currentRegion()]);
 
-    glDrawArrays(GL_TRIANGLES, 0, kNumVertices);
-
-    glDisableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    glUseProgram(0);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(sNumVertices));
+    sGpuProfiler.endScope();
+    sVertexStream.endRegion();
+    sGLState.endFrame();
+    sGpuProfiler.endFrame();
 }
 
 /**
- * @brief Clean up the OpenGL objects when closing the window, and destroy the
- *        window.
+ * @brief Clean up the OpenGL objects, and release the window or the offscreen framebuffer of
+ *        `sDisplay`.
  */
-void windowCloseCallback(GLFWwindow *window) {
+void terminate() {
     printf("Deleting OpenGL objects...\n");
     glDeleteProgram(sGLProgram);
-    glDeleteBuffers(1, &sVBO);
-    glDeleteVertexArrays(1, &sVAO);
+    sVertexStream.destroy();
+    glDeleteVertexArrays(stream::kMaxRegions, sVAOs);
+    sGpuProfiler.destroy();
 
-    printf("Closing window...\n");
-    glfwDestroyWindow(window);
+    printf("Closing display...\n");
+    sDisplay.destroy();
 }
 
-void terminate(GLFWwindow *window) {
-    windowCloseCallback(window);
-    glfwTerminate();
-}
+int main(int argc, char **argv) {
+    if (utils::hasArg(argc, argv, "--bench-rotation")) {
+        runRotationBenchmark(utils::parseArgSize(argc, argv, "--bench-rotation", 1 << 22));
+        return 0;
+    }
+    if (utils::hasArg(argc, argv, "--bench-threads")) {
+        runThreadScalingBenchmark(utils::parseArgSize(argc, argv, "--bench-threads", 1 << 22));
+        return 0;
+    }
+    bench::Options benchOptions;
+    display::Options displayOptions;
+    if (!bench::parseOptions(argc, argv, benchOptions) ||
+        !display::parseOptions(argc, argv, displayOptions)) {
+        return -1;
+    }
+    const char *tracePath = utils::findArgValue(argc, argv, "--trace");
+    if (tracePath) {
+        tracing::start();
+        tracing::setThreadName("main");
+    }
+    jobs::JobSystem jobSystem(
+        utils::parseArgSize(argc, argv, "--threads", 0, jobs::JobSystem::maxThreads()));
+    sJobSystem = &jobSystem;
+    sNumInstances = utils::parseArgSize(argc, argv, "--instances", 1);
+    if (!initSceneData()) {
+        return -1;
+    }
 
-int main() {
-    GLFWwindow *window = utils::initGLFW("Triforce CPU");
-    utils::setGLFWCallbacks(
-        window, utils::KEY_CALLBACK | utils::RESIZE_CALLBACK | utils::WINDOW_CLOSE_CALLBACK);
-    glfwSwapInterval(1);
+    if (!sDisplay.init("Triforce CPU", displayOptions)) {
+        return -1;
+    }
+    if (sDisplay.window()) {
+        // Closing the window only ends the loop, `sDisplay.destroy` tears it down.
+        utils::setGLFWCallbacks(sDisplay.window(), utils::KEY_CALLBACK | utils::RESIZE_CALLBACK);
+    }
+    sDisplay.setSwapInterval(benchOptions.numFrames > 0 ? 0 : 1);
 
+    if (!utils::hasArg(argc, argv, "--no-shader-cache")) {
+        const char *cacheDir = utils::findArgValue(argc, argv, "--shader-cache");
+        sProgramCache.init(cacheDir ? cacheDir : shaders::kDefaultCacheDirectory);
+    }
     if (!initShaderProgram()) {
-        terminate(window);
+        terminate();
+        return -1;
+    }
+    if (!initBufferObjects()) {
+        terminate();
         return -1;
     }
-    initBufferObjects();
 
-    double timer = 0.0;
-    int fps = 0;
-    while (glfwWindowShouldClose(window) == GLFW_FALSE) {
-        updateScene();
+    sFrameStats.init(std::max(telemetry::kDefaultCapacity, benchOptions.numFrames));
+    sGpuProfiler.init();
+    bench::FixedStep simClock;
+    simClock.init(benchOptions.stepSeconds, benchOptions.numFrames > 0);
+    double startTime = sDisplay.time();
+    double lastTime = startTime;
+    size_t frameIdx = 0;
+    while (!sDisplay.shouldClose() &&
+           (benchOptions.numFrames == 0 || frameIdx < benchOptions.numFrames)) {
+        double time = sDisplay.time();
+        size_t numSteps = simClock.advance(time - lastTime);
+        lastTime = time;
+
+        sFrameStats.beginFrame();
+        sFrameStats.beginUpdate();
+        updateScene(numSteps);
+        sFrameStats.endUpdate();
         renderScene();
-        glfwSwapBuffers(window);
-        fps++;
+        sFrameStats.beginSwap();
+        sDisplay.swapBuffers();
+        sFrameStats.endSwap();
+        sDisplay.pollEvents();
+        sFrameStats.endFrame();
+        frameIdx++;
 
-        if (glfwGetTime() - timer > 1.0) {
-            timer++;
+        size_t numFrames = 0;
+        telemetry::Summary summary = {};
+        if (sFrameStats.reportDue(1.0, numFrames) && sFrameStats.summarize(numFrames, summary)) {
+            char summaryStr[128];
+            char gpuStr[128];
+            telemetry::formatSummary(summary, summaryStr, sizeof(summaryStr));
+            sGpuProfiler.format(gpuStr, sizeof(gpuStr));
             printf("\r\x1b[A\x1b[2K");
-            printf("FPS: %d\n", fps);
-            fps = 0;
+            printf(
+                "FPS: %.0f, %s, %s (GL state changes per frame: %zu issued, %zu skipped)\n",
+                summary.fps,
+                summaryStr,
+                gpuStr,
+                sGLState.lastFrame().issued,
+                sGLState.lastFrame().skipped);
         }
-        glfwPollEvents();
     }
-    glfwTerminate();
+    if (benchOptions.numFrames > 0) {
+        glFinish();
+        bench::Report report = {
+            "triforceCPU",
+            frameIdx,
+            sDisplay.time() - startTime,
+            sNumVertices,
+            simClock.numSteps(),
+            utils::hashBytes(
+                utils::kFnvOffsetBasis, sVboData, sNumVertices * kDataPerVertex * sizeof(float)),
+            rotation::kernelName(rotation::bestKernel()),
+        };
+        bench::printReport(report, sFrameStats);
+    }
+    telemetry::reportAtExit(sFrameStats, utils::findArgValue(argc, argv, "--frame-stats"));
+    if (tracePath) {
+        tracing::writeChromeTrace(tracePath);
+    }
+    terminate();
+
     return 0;
 }
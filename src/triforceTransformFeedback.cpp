@@ -2,62 +2,70 @@
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
-
+#include <algorithm>
+
+#include "base/arena.h"
+#include "base/benchmark.h"
+#include "base/display.h"
+#include "base/frameStats.h"
+#include "base/gpuProfiler.h"
+#include "base/linalg.h"
+#include "base/programCache.h"
+#include "base/rotation.h"
+#include "base/shaderBatch.h"
+#include "base/trace.h"
+#include "base/triforce.h"
 #include "base/utils.h"
+#include "base/vertexLayout.h"
 
 // Number of entries that represent a single vertex.
 static const size_t kDataPerVertex = 3;
-// Total number of vertices present in the vertex buffer object.
-static const size_t kNumVertices = 9;
-// Triangle vertex positions in 3D space. Each 3 entries represent a single.
-static const float kInitialVertexData[kNumVertices * kDataPerVertex] = {
-    // clang-format off
-    // Upper triangle
-    0.0, 0.5, 0.0,
-    -0.25, 0.0, 0.0,
-    0.25, 0.0, 0.0,
-    // Down left triangle
-    -0.25, 0.0, 0.0,
-    -0.5, -0.5, 0.0,
-    0.0, -0.5, 0.0,
-    // Down right triangle
-    0.25, 0.0, 0.0,
-    0.0, -0.5, 0.0,
-    0.5, -0.5, 0.0,
-    // clang-format on
-};
-static const size_t kVertexDataSize = sizeof(kInitialVertexData);
 
-// Vertex shader in raw string representation.
+// Number of triforces tiled over the scene, selected at startup with `--instances=N`.
+static size_t sNumInstances = 1;
+
+// Total number of vertices present in the vertex buffer objects.
+static size_t sNumVertices = triforce::kVerticesPerInstance;
+
+// Size in bytes of the vertex positions.
+static size_t sVertexDataSize = 0;
+
+// Arena holding the initial vertex positions until they are uploaded to the GPU.
+static memory::Arena sArena;
+
+// Triangle vertex positions in 3D space, allocated from `sArena`. Each 3 entries represent a
+// single vertex.
+static float* sInitialVertexData = nullptr;
+
+// Vertex shader in raw string representation. The rotation of the simulation steps of the frame
+// is baked on the CPU into the `rotation` uniform.
 static const char* sVertexShaderStr =
     R"glsl(#version 460
 layout(location = 0) in vec3 inPos;
 layout(location = 0) uniform uint mode;
+layout(location = 1) uniform mat3 rotation;
 layout(location = 0) out vec3 outPos;
 
-const float phi = 2.0 * 3.14159 / 100;
-
 void main() {
     if (mode == 0) {
-        outPos.x =
-            (2.0 * inPos.x + 2.0 * inPos.z + inPos.y * cos(phi) + 2.0 * inPos.x * cos(2.0 * phi) -
-             2.0 * inPos.z * cos(2.0 * phi) - inPos.y * cos(3.0 * phi) + inPos.z * sin(phi) -
-             2.0 * inPos.y * sin(2.0 * phi) + inPos.z * sin(3.0 * phi)) /
-            4.0;
-        outPos.y =
-            (2.0 * inPos.y + inPos.z * cos(phi) + 2.0 * inPos.y * cos(2.0 * phi) -
-             inPos.z * cos(3.0 * phi) + 3.0 * inPos.y * sin(phi) + 2.0 * inPos.x * sin(2.0 * phi) -
-             2.0 * inPos.z * sin(2.0 * phi) - inPos.y * sin(3.0 * phi)) /
-            4.0;
-        outPos.z = (inPos.z + inPos.z * cos(2.0 * phi) - 2.0 * inPos.x * sin(phi) +
-                    inPos.y * sin(2.0 * phi)) /
-                   2.0;
+        outPos = rotation * inPos;
     } else {
         gl_Position = vec4(inPos, 1.0);
     }
 })glsl";
 
+// Angle variation per simulation step for each axis.
+static const float kDeltaAngle = 2.0F * PI / 100.0F;
+
+// Number of simulation steps of the rotation in the `rotation` uniforms, so that they are only
+// uploaded again when the number of steps of a frame changes.
+static size_t sRotationSteps = 0;
+
+// Layout location of the `rotation` uniform, in both the vertex and compute shaders.
+static const GLint kRotationUniformLoc = 1;
+
 // Update mode for the vertex shader by setting `mode` to `kModeRender`.
 static const GLint kModeUpdate = 0;
 
@@ -82,155 +90,512 @@ void main() {
     outCol = vec4(1.0, 0.843, 0.0, 1.0);
 })glsl";
 
+// Compute shader updating the vertex positions in place, in raw string representation. The
+// positions are read as a flat array of floats to match the tightly packed vertex buffer.
+static const char* sComputeShaderStr =
+    R"glsl(#version 460
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer Positions {
+    float positions[];
+};
+layout(location = 0) uniform uint numVertices;
+layout(location = 1) uniform mat3 rotation;
+
+void main() {
+    // Large dispatches are split along y, as the number of work groups per dimension is limited.
+    uint groupIdx = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint idx = groupIdx * gl_WorkGroupSize.x + gl_LocalInvocationID.x;
+    if (idx >= numVertices) {
+        return;
+    }
+    vec3 inPos = vec3(positions[3 * idx], positions[3 * idx + 1], positions[3 * idx + 2]);
+    vec3 outPos = rotation * inPos;
+
+    positions[3 * idx] = outPos.x;
+    positions[3 * idx + 1] = outPos.y;
+    positions[3 * idx + 2] = outPos.z;
+})glsl";
+
+// Number of invocations per work group of the compute shader, must match `local_size_x`.
+static const GLuint kWorkGroupSize = 256;
+
+// Layout location of the `numVertices` uniform of the compute shader.
+static const GLint kNumVerticesUniformLoc = 0;
+
+// Maximum number of work groups dispatched along x, the minimum limit guaranteed by OpenGL.
+static const GLuint kMaxWorkGroupsX = 65535;
+
+// Binding point of the shader storage buffer holding the positions.
+static const GLuint kPositionsBinding = 0;
+
+// Vertex shader drawing the positions updated by the compute shader, in raw string representation.
+static const char* sDrawVertexShaderStr =
+    R"glsl(#version 460
+layout(location = 0) in vec3 inPos;
+
+void main() {
+    gl_Position = vec4(inPos, 1.0);
+})glsl";
+
+// Ways of updating the vertex positions on the GPU.
+enum class UpdateMode {
+    TRANSFORM_FEEDBACK,
+    COMPUTE,
+};
+
+// Update mode selected at startup with `--mode=feedback` or `--mode=compute`.
+static UpdateMode sUpdateMode = UpdateMode::TRANSFORM_FEEDBACK;
+
+// On-disk cache of the linked programs, see `--shader-cache=DIR` and `--no-shader-cache`.
+static shaders::ProgramCache sProgramCache;
+
+// Batch compiling every program in the background while the buffers are created.
+static shaders::ProgramBatch sProgramBatch;
+
+// Shader sources of the programs, which must outlive `sProgramBatch`.
+static const shaders::ShaderSource kUpdateSources[2] = {
+    {GL_VERTEX_SHADER, sVertexShaderStr},
+    {GL_FRAGMENT_SHADER, sFragmentShaderStr},
+};
+static const shaders::ShaderSource kComputeSources[1] = {{GL_COMPUTE_SHADER, sComputeShaderStr}};
+static const shaders::ShaderSource kDrawSources[2] = {
+    {GL_VERTEX_SHADER, sDrawVertexShaderStr},
+    {GL_FRAGMENT_SHADER, sFragmentShaderStr},
+};
+static const char* kFeedbackVaryings[1] = {"outPos"};
+
 // OpenGL program containing the vertex and fragment shader.
 static GLuint sGLProgram = 0;
 
-// Vertex buffer object.
-static GLuint sVBO = 0;
+// Program containing the compute shader updating the positions.
+static GLuint sComputeProgram = 0;
+
+// Program drawing the positions updated by `sComputeProgram`.
+static GLuint sDrawProgram = 0;
+
+// Vertex buffer objects swapping roles every frame: one is the source of the update pass while
+// the other captures its transform feedback, and is then drawn.
+static GLuint sVertexBuffers[2] = {0};
+
+// Layout of the vertices: tightly packed positions fetched from binding 0, at the location fixed
+// by the `layout` qualifier of `inPos` in both vertex shaders.
+static const vertex::Attrib kVertexAttribs[1] = {{0, kDataPerVertex, GL_FLOAT, GL_FALSE, 0, 0}};
+static const vertex::Binding kVertexBindings[1] = {{0, kDataPerVertex * sizeof(float), 0}};
+static const vertex::Layout kVertexLayout = {kVertexAttribs, 1, kVertexBindings, 1};
+
+// Vertex array objects reading the attributes from the respective vertex buffer.
+static GLuint sVAOs[2] = {0};
+
+// Transform feedback objects capturing into the respective vertex buffer.
+static GLuint sTransformFeedbacks[2] = {0};
+
+// Index of the vertex buffer holding the latest vertex positions.
+static size_t sCurrentBufferIdx = 0;
 
-// Transform feedback vertex buffer object.
-static GLuint sTBO = 0;
+// Whether to use the original path, copying the captured vertices back into the source buffer
+// with `glCopyBufferSubData` every frame instead of swapping the buffers.
+static bool sUseCopyPath = false;
 
-// Vertex array object.
-static GLuint sVAO = 0;
+// GPU timings of the copy, update and render passes.
+static profiling::GpuProfiler sGpuProfiler;
+
+// Timings of the last frames, reported once per second and at exit. The vertices are updated on
+// the GPU, so the frames mark no update.
+static telemetry::FrameStats sFrameStats;
+
+// Window, or offscreen framebuffer with `--headless`, the frames are rendered to.
+static display::Display sDisplay;
 
 /**
- * @brief Initializes the OpenGL program object `sGLProgram` by creating the shaders
- *        from `sVertexShaderStr` and `sFragmentShaderStr`. If the creation of the
- *        program fails, the function will toggle the GLFW window to close.
- *
- * @param window Window associated to the OpenGL context.
+ * @brief Submits the creation of every program to `sProgramBatch` without waiting for it:
+ *        `sGLProgram`, capturing `outPos` with transform feedback, and the programs of the compute
+ *        update mode, `sComputeProgram`, updating the positions in place, and `sDrawProgram`,
+ *        drawing them.
  */
-bool initShaderProgram() {
-    GLuint vertexShader, fragmentShader;
-    if (!(utils::createShaderFromString(vertexShader, GL_VERTEX_SHADER, sVertexShaderStr) &&
-          utils::createShaderFromString(fragmentShader, GL_FRAGMENT_SHADER, sFragmentShaderStr))) {
+bool submitShaderPrograms() {
+    static const shaders::ProgramDesc kUpdateDesc = {
+        kUpdateSources, 2, kFeedbackVaryings, 1, GL_INTERLEAVED_ATTRIBS};
+    static const shaders::ProgramDesc kComputeDesc = {kComputeSources, 1, nullptr, 0, GL_NONE};
+    static const shaders::ProgramDesc kDrawDesc = {kDrawSources, 2, nullptr, 0, GL_NONE};
+    if (!(sProgramBatch.add(sGLProgram, kUpdateDesc) &&
+          sProgramBatch.add(sComputeProgram, kComputeDesc) &&
+          sProgramBatch.add(sDrawProgram, kDrawDesc))) {
         return false;
     }
+    sProgramBatch.submit(&sProgramCache);
+    return true;
+}
 
-    sGLProgram = glCreateProgram();
-    if (sGLProgram == 0) {
-        fprintf(stderr, "Unable to create program object.\n");
+/**
+ * @brief Waits for the programs submitted by `submitShaderPrograms` and queries the locations used
+ *        by `sGLProgram`.
+ */
+bool finishShaderPrograms() {
+    if (!sProgramBatch.finish()) {
+        fprintf(stderr, "Unable to create program objects.\n");
         return false;
     }
-    glAttachShader(sGLProgram, vertexShader);
-    glAttachShader(sGLProgram, fragmentShader);
-
-    const char* varyings[1] = {"outPos"};
-    glTransformFeedbackVaryings(sGLProgram, 1, varyings, GL_INTERLEAVED_ATTRIBS);
-    utils::linkProgram(sGLProgram);
 
     if (!(utils::findAttribLocation(sGLProgram, sModeUniformLoc, "mode", true) &&
           utils::findAttribLocation(sGLProgram, sInPosAttribLoc, "inPos", false))) {
         fprintf(stderr, "Unable to find attribute location.\n");
         return false;
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 
     return true;
 }
 
-void initBufferObjects() {
-    glGenVertexArrays(1, &sVAO);
-    glBindVertexArray(sVAO);
-
-    // Create the vertex buffer and declare how much data will it carry.
-    glGenBuffers(1, &sVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glBufferData(GL_ARRAY_BUFFER, kVertexDataSize, nullptr, GL_DYNAMIC_DRAW);
-
-    // Create the tranform feedback buffer and copy the initial positions of vertices.
-    glGenBuffers(1, &sTBO);
-    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, sTBO);
-    glBufferData(
-        GL_TRANSFORM_FEEDBACK_BUFFER, kVertexDataSize, kInitialVertexData, GL_DYNAMIC_DRAW);
+/**
+ * @brief Allocates `sInitialVertexData` from `sArena` and tiles `sNumInstances` triforces over it.
+ */
+bool initSceneData() {
+    if (sNumInstances == 0) {
+        fprintf(stderr, "The scene requires at least one triforce.\n");
+        return false;
+    }
+    if (sNumInstances > triforce::kMaxInstances) {
+        fprintf(
+            stderr,
+            "The scene holds at most %zu triforces, %zu requested.\n",
+            triforce::kMaxInstances,
+            sNumInstances);
+        return false;
+    }
+    sNumVertices = sNumInstances * triforce::kVerticesPerInstance;
+    sVertexDataSize = sNumVertices * kDataPerVertex * sizeof(float);
+    if (!sArena.init(sVertexDataSize)) {
+        return false;
+    }
+    sInitialVertexData = sArena.allocArray<float>(sNumVertices * kDataPerVertex);
+    triforce::tile(sInitialVertexData, sNumInstances, kDataPerVertex);
+
+    printf("Scene: %zu triforces, %zu vertices.\n", sNumInstances, sNumVertices);
+    return true;
 }
 
-void renderScene() {
-    glClearColor(0.0, 0.0, 0.0, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(sGLProgram);
+/**
+ * @brief Uploads the rotation of the simulation steps of the frame, computed on the CPU, to the
+ *        update programs. The update pass runs even without any step, with the identity.
+ *
+ * @param numSteps Number of simulation steps of the frame, each rotating by `kDeltaAngle`.
+ * @param force Whether to upload the rotation even if the number of steps didn't change.
+ */
+void updateRotationUniforms(size_t numSteps, bool force) {
+    if (!force && numSteps == sRotationSteps) {
+        return;
+    }
+    linalg::Mat3 rotationMat = rotation::rotationMatrixSteps(kDeltaAngle, numSteps);
+    glProgramUniformMatrix3fv(sGLProgram, kRotationUniformLoc, 1, GL_FALSE, rotationMat.m);
+    glProgramUniformMatrix3fv(sComputeProgram, kRotationUniformLoc, 1, GL_FALSE, rotationMat.m);
+    sRotationSteps = numSteps;
+}
+
+/** @brief Vertex buffer holding the latest vertex positions, in the current update mode. */
+GLuint currentVertexBuffer() {
+    if (sUpdateMode == UpdateMode::COMPUTE) {
+        return sVertexBuffers[0];
+    }
+    return sUseCopyPath ? sVertexBuffers[1] : sVertexBuffers[sCurrentBufferIdx];
+}
+
+/**
+ * @brief Hashes the latest vertex positions, read back from the GPU, to compare the state of
+ *        benchmark runs.
+ */
+uint64_t hashVertices() {
+    GLuint buffer = currentVertexBuffer();
+    const void* data = glMapNamedBufferRange(
+        buffer, 0, static_cast<GLsizeiptr>(sVertexDataSize), GL_MAP_READ_BIT);
+    if (!data) {
+        fprintf(stderr, "Unable to map the vertex buffer to hash it.\n");
+        return 0;
+    }
+    uint64_t hash = utils::hashBytes(utils::kFnvOffsetBasis, data, sVertexDataSize);
+    glUnmapNamedBuffer(buffer);
+    return hash;
+}
 
-    // Update the state of the vertex buffer with the previous trasform feedback.
-    glBindBuffer(GL_ARRAY_BUFFER, sVBO);
-    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, sOutPosAttribLoc, sTBO);
-    glCopyBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, GL_ARRAY_BUFFER, 0, 0, kVertexDataSize);
+/**
+ * @brief Creates both vertex buffers with the initial vertex positions, along with the vertex
+ *        array and transform feedback objects associated with each of them. The attribute format
+ *        and the capture bindings are only specified here, once. The shader programs may still be
+ *        compiling, so the attribute location is the one fixed by the `layout` qualifier of
+ *        `inPos`, see `kVertexLayout`.
+ */
+void initBufferObjects() {
+    glGenBuffers(2, sVertexBuffers);
+    glGenTransformFeedbacks(2, sTransformFeedbacks);
+
+    for (size_t idx = 0; idx < 2; idx++) {
+        glBindBuffer(GL_ARRAY_BUFFER, sVertexBuffers[idx]);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(sVertexDataSize),
+            sInitialVertexData,
+            GL_DYNAMIC_COPY);
+
+        sVAOs[idx] = vertex::createVertexArray(kVertexLayout);
+        vertex::bindVertexBuffer(kVertexLayout, 0, sVertexBuffers[idx], 0);
+
+        glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, sTransformFeedbacks[idx]);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, sOutPosAttribLoc, sVertexBuffers[idx]);
+    }
 
-    glEnableVertexAttribArray(sInPosAttribLoc);
-    glVertexAttribPointer(sInPosAttribLoc, kDataPerVertex, GL_FLOAT, GL_FALSE, 0, 0);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // The vertices now live on the GPU only.
+    sArena.destroy();
+    sInitialVertexData = nullptr;
+}
 
-    // Update the transform feedback buffer, without rendering.
+/**
+ * @brief Runs the update pass, reading the vertices from the buffer `src` and capturing the
+ *        transformed vertices into the buffer `dst`, without rasterizing anything.
+ */
+void updatePass(size_t src, size_t dst) {
+    TRACE_FUNCTION();
+    profiling::GpuScope scope(sGpuProfiler, "update");
     glUniform1ui(static_cast<GLint>(sModeUniformLoc), kModeUpdate);
+    glBindVertexArray(sVAOs[src]);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, sTransformFeedbacks[dst]);
     glEnable(GL_RASTERIZER_DISCARD);
     {
         glBeginTransformFeedback(GL_TRIANGLES);
-        glDrawArrays(GL_TRIANGLES, 0, kNumVertices);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(sNumVertices));
         glEndTransformFeedback();
     }
     glDisable(GL_RASTERIZER_DISCARD);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+}
+
+/**
+ * @brief Original path: copies the previously captured vertices back into the first buffer, which
+ *        is always the source of the update pass, and always captures into the second buffer.
+ */
+void renderSceneCopy() {
+    {
+        profiling::GpuScope scope(sGpuProfiler, "copy");
+        glBindBuffer(GL_COPY_READ_BUFFER, sVertexBuffers[1]);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, sVertexBuffers[0]);
+        glCopyBufferSubData(
+            GL_COPY_READ_BUFFER,
+            GL_COPY_WRITE_BUFFER,
+            0,
+            0,
+            static_cast<GLsizeiptr>(sVertexDataSize));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
 
-    // Render the newly obtained data in the transform feedback buffer.
+    updatePass(0, 1);
+
+    profiling::GpuScope scope(sGpuProfiler, "render");
     glUniform1ui(static_cast<GLint>(sModeUniformLoc), kModeRender);
-    glBindBuffer(GL_ARRAY_BUFFER, sTBO);
-    glDrawArrays(GL_TRIANGLES, 0, kNumVertices);
+    glBindVertexArray(sVAOs[1]);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(sNumVertices));
+}
 
-    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
-    glDisableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+/**
+ * @brief Ping-pong path: the buffer captured in the previous frame becomes the source of the
+ *        update pass, and the newly captured buffer is drawn with the vertex count recorded by its
+ *        transform feedback object. The vertices never leave the GPU and are never copied.
+ */
+void renderScenePingPong() {
+    size_t src = sCurrentBufferIdx;
+    size_t dst = 1 - src;
+    updatePass(src, dst);
+
+    {
+        profiling::GpuScope scope(sGpuProfiler, "render");
+        glUniform1ui(static_cast<GLint>(sModeUniformLoc), kModeRender);
+        glBindVertexArray(sVAOs[dst]);
+        glDrawTransformFeedback(GL_TRIANGLES, sTransformFeedbacks[dst]);
+    }
+
+    sCurrentBufferIdx = dst;
+}
+
+/**
+ * @brief Compute path: the positions in the first vertex buffer are updated in place as a shader
+ *        storage buffer, with one invocation per vertex, and then drawn directly.
+ */
+void renderSceneCompute() {
+    {
+        profiling::GpuScope scope(sGpuProfiler, "update");
+        glUseProgram(sComputeProgram);
+        GLuint numVertices = static_cast<GLuint>(sNumVertices);
+        glUniform1ui(kNumVerticesUniformLoc, numVertices);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kPositionsBinding, sVertexBuffers[0]);
+        GLuint numWorkGroups = (numVertices + kWorkGroupSize - 1) / kWorkGroupSize;
+        GLuint numWorkGroupsX = numWorkGroups < kMaxWorkGroupsX ? numWorkGroups : kMaxWorkGroupsX;
+        GLuint numWorkGroupsY = (numWorkGroups + numWorkGroupsX - 1) / numWorkGroupsX;
+        glDispatchCompute(numWorkGroupsX, numWorkGroupsY, 1);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kPositionsBinding, 0);
+
+        // The vertex fetch must see the writes of the compute shader.
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+
+    profiling::GpuScope scope(sGpuProfiler, "render");
+    glUseProgram(sDrawProgram);
+    glBindVertexArray(sVAOs[0]);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(sNumVertices));
+}
+
+void renderScene() {
+    TRACE_FUNCTION();
+    sGpuProfiler.beginFrame();
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (sUpdateMode == UpdateMode::COMPUTE) {
+        renderSceneCompute();
+    } else {
+        glUseProgram(sGLProgram);
+        if (sUseCopyPath) {
+            renderSceneCopy();
+        } else {
+            renderScenePingPong();
+        }
+    }
+
+    glBindVertexArray(0);
     glUseProgram(0);
+    sGpuProfiler.endFrame();
 }
 
 void terminateRenderer() {
     fprintf(stderr, "Deleting OpenGL objects...\n");
-    glEndTransformFeedback();
-    glDeleteTransformFeedbacks(1, &sTBO);
     glBindVertexArray(0);
-    glDeleteVertexArrays(1, &sVAO);
-    glDeleteBuffers(1, &sVBO);
+    glDeleteTransformFeedbacks(2, sTransformFeedbacks);
+    glDeleteVertexArrays(2, sVAOs);
+    glDeleteBuffers(2, sVertexBuffers);
     glDeleteProgram(sGLProgram);
+    glDeleteProgram(sComputeProgram);
+    glDeleteProgram(sDrawProgram);
+    sGpuProfiler.destroy();
 }
 
-void terminate(GLFWwindow* window) {
-    utils::windowCloseCallbackGLFW(window);
+void terminate() {
     terminateRenderer();
-    glfwTerminate();
+    sDisplay.destroy();
 }
 
-int main() {
-    GLFWwindow* window = utils::initGLFW("Triforce Transform Feedback");
-    utils::setGLFWCallbacks(
-        window, utils::KEY_CALLBACK | utils::RESIZE_CALLBACK | utils::WINDOW_CLOSE_CALLBACK);
-    glfwSwapInterval(1);
+int main(int argc, char** argv) {
+    bench::Options benchOptions;
+    display::Options displayOptions;
+    if (!bench::parseOptions(argc, argv, benchOptions) ||
+        !display::parseOptions(argc, argv, displayOptions)) {
+        return -1;
+    }
+    const char* tracePath = utils::findArgValue(argc, argv, "--trace");
+    if (tracePath) {
+        tracing::start();
+        tracing::setThreadName("main");
+    }
+    sUseCopyPath = utils::hasArg(argc, argv, "--tf-copy");
+    sNumInstances = utils::parseArgSize(argc, argv, "--instances", 1);
+    if (!initSceneData()) {
+        return -1;
+    }
+    const char* modeStr = utils::findArgValue(argc, argv, "--mode");
+    if (modeStr && strcmp(modeStr, "compute") == 0) {
+        sUpdateMode = UpdateMode::COMPUTE;
+    } else if (modeStr && strcmp(modeStr, "feedback") != 0) {
+        fprintf(stderr, "Unknown update mode '%s', expected 'feedback' or 'compute'.\n", modeStr);
+        return -1;
+    }
+
+    if (!sDisplay.init("Triforce Transform Feedback", displayOptions)) {
+        return -1;
+    }
+    if (sDisplay.window()) {
+        // Closing the window only ends the loop, `sDisplay.destroy` tears it down.
+        utils::setGLFWCallbacks(sDisplay.window(), utils::KEY_CALLBACK | utils::RESIZE_CALLBACK);
+    }
+    sDisplay.setSwapInterval(benchOptions.numFrames > 0 ? 0 : 1);
 
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(utils::errorCallbackGL, 0);
 
-    if (!initShaderProgram()) {
-        utils::windowCloseCallbackGLFW(window);
-        terminateRenderer();
-        glfwTerminate();
-        terminate(window);
+    if (!utils::hasArg(argc, argv, "--no-shader-cache")) {
+        const char* cacheDir = utils::findArgValue(argc, argv, "--shader-cache");
+        sProgramCache.init(cacheDir ? cacheDir : shaders::kDefaultCacheDirectory);
+    }
+    if (!submitShaderPrograms()) {
+        terminate();
+        return -1;
     }
-
     initBufferObjects();
+    if (!finishShaderPrograms()) {
+        terminate();
+        return -1;
+    }
+    updateRotationUniforms(0, true);
+    sGpuProfiler.init();
+    if (sUpdateMode == UpdateMode::COMPUTE) {
+        printf("Updating vertices in place with a compute shader.\n");
+    } else {
+        printf(
+            "Updating vertices with %s.\n",
+            sUseCopyPath ? "a buffer copy per frame" : "ping-pong transform feedback buffers");
+    }
 
-    double timer = 0.0;
-    int fps = 0;
-    while (glfwWindowShouldClose(window) == GLFW_FALSE) {
+    sFrameStats.init(std::max(telemetry::kDefaultCapacity, benchOptions.numFrames));
+    bench::FixedStep simClock;
+    simClock.init(benchOptions.stepSeconds, benchOptions.numFrames > 0);
+    double startTime = sDisplay.time();
+    double lastTime = startTime;
+    size_t frameIdx = 0;
+    while (!sDisplay.shouldClose() &&
+           (benchOptions.numFrames == 0 || frameIdx < benchOptions.numFrames)) {
+        double time = sDisplay.time();
+        size_t numSteps = simClock.advance(time - lastTime);
+        lastTime = time;
+
+        sFrameStats.beginFrame();
+        updateRotationUniforms(numSteps, false);
         renderScene();
-        glfwSwapBuffers(window);
-        fps++;
-        if (glfwGetTime() - timer > 1.0) {
-            timer++;
+        sFrameStats.beginSwap();
+        sDisplay.swapBuffers();
+        sFrameStats.endSwap();
+        sDisplay.pollEvents();
+        sFrameStats.endFrame();
+        frameIdx++;
+
+        size_t numFrames = 0;
+        telemetry::Summary summary = {};
+        if (sFrameStats.reportDue(1.0, numFrames) && sFrameStats.summarize(numFrames, summary)) {
+            char summaryStr[128];
+            char gpuStr[128];
+            telemetry::formatSummary(summary, summaryStr, sizeof(summaryStr));
+            sGpuProfiler.format(gpuStr, sizeof(gpuStr));
             printf("\r\x1b[A\x1b[2K");
-            printf("FPS: %d\n", fps);
-            fps = 0;
+            printf("FPS: %.0f, %s, %s\n", summary.fps, summaryStr, gpuStr);
         }
-        glfwPollEvents();
     }
-    terminateRenderer();
-    glfwTerminate();
+    if (benchOptions.numFrames > 0) {
+        glFinish();
+        double totalSeconds = sDisplay.time() - startTime;
+        bench::Report report = {
+            "triforceTransformFeedback",
+            frameIdx,
+            totalSeconds,
+            sNumVertices,
+            simClock.numSteps(),
+            hashVertices(),
+            sUpdateMode == UpdateMode::COMPUTE ? "gpu compute" : "gpu transform feedback",
+        };
+        bench::printReport(report, sFrameStats);
+    }
+    telemetry::reportAtExit(sFrameStats, utils::findArgValue(argc, argv, "--frame-stats"));
+    if (tracePath) {
+        tracing::writeChromeTrace(tracePath);
+    }
+    terminate();
 
     return 0;
 }